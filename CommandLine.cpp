@@ -0,0 +1,484 @@
+#include "header.h"
+#include "Solver.h"
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace WordGame {
+
+    //------------------------------------------------------------------------------
+    // printUsage
+    // Lists the command line modes.
+    //------------------------------------------------------------------------------
+    static void printUsage(const char* program) {
+        std::cout << "Usage:\n";
+        std::cout << "  " << program << "                      Play the game\n";
+        std::cout << "  " << program << " --generate <easy|hard> <level> [options]\n";
+        std::cout << "  " << program << " --batch <easy|hard> <level> <count> [options]\n";
+        std::cout << "  " << program << " --serve [--host addr] [--port n] [--unix path] [--loops n]\n";
+        std::cout << "  " << program << " --footprint <sessions> [--mode easy|hard] [--level n]\n";
+        std::cout << "      --engine <random|backtracking>  Placement engine (default random)\n";
+        std::cout << "      --size <n>                      Grid size instead of the level's\n";
+        std::cout << "      --words <n>                     Words to place instead of the level's\n";
+        std::cout << "      --file <path>                   Word list or compiled dictionary\n";
+        std::cout << "      --seed <n>                      Seed for reproducible grids\n";
+        std::cout << "      --threads <n>                   Batch workers (default one per core)\n";
+        std::cout << "      --quiet                         Print the report only, not the grid\n";
+        std::cout << "      --solve                         Check each grid with the solver and list its words\n";
+        std::cout << "      --tiled <path>                  Generate a tiled grid in a scratch file (with --size)\n";
+        std::cout << "      --tile <n>                      Cells per tile side for --tiled (default 1024)\n";
+        std::cout << "      --loops <n>                     Server event loops (0 for one per core)\n";
+    }
+
+    // Settings shared by --generate and --batch
+    struct GenerateOptions {
+        std::string modeName;
+        int level = 0;
+        std::string filename;
+        GeneratorEngine engine = GeneratorEngine::RandomProbe;
+        int gridSize = 0;
+        int wordCount = 0;
+        bool seeded = false;
+        std::uint64_t seed = 0;
+        int threads = 0;
+        bool quiet = false;
+        bool solve = false; // Run the solver over each generated grid
+        std::string tiledPath; // Scratch file for a TiledGrid, empty for an in-memory grid
+        int tileSize = 1024;
+    };
+
+    //------------------------------------------------------------------------------
+    // parseGenerateOptions
+    // Reads the mode, the level and the options that follow argv[first].
+    // Returns false on anything it does not understand, and on a grid or tile
+    // size that is not positive.
+    //------------------------------------------------------------------------------
+    static bool parseGenerateOptions(int argc, char* argv[], int first, GenerateOptions& options) {
+        if (argc < 4) {
+            return false;
+        }
+        options.modeName = argv[2];
+        options.level = std::atoi(argv[3]);
+        if ((options.modeName != "easy" && options.modeName != "hard") || options.level < 1 || options.level > 3) {
+            return false;
+        }
+        options.filename = options.modeName + "_words.txt";
+
+        for (int i = first; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--engine" && i + 1 < argc) {
+                std::string engine = argv[++i];
+                options.engine = engine == "backtracking" ? GeneratorEngine::Backtracking : GeneratorEngine::RandomProbe;
+            }
+            else if (arg == "--size" && i + 1 < argc) {
+                options.gridSize = std::atoi(argv[++i]);
+                if (options.gridSize <= 0) {
+                    return false;
+                }
+            }
+            else if (arg == "--words" && i + 1 < argc) {
+                options.wordCount = std::atoi(argv[++i]);
+            }
+            else if (arg == "--file" && i + 1 < argc) {
+                options.filename = argv[++i];
+            }
+            else if (arg == "--seed" && i + 1 < argc) {
+                options.seed = std::strtoull(argv[++i], nullptr, 0);
+                options.seeded = true;
+            }
+            else if (arg == "--threads" && i + 1 < argc) {
+                options.threads = std::atoi(argv[++i]);
+            }
+            else if (arg == "--quiet") {
+                options.quiet = true;
+            }
+            else if (arg == "--solve") {
+                options.solve = true;
+            }
+            else if (arg == "--tiled" && i + 1 < argc) {
+                options.tiledPath = argv[++i];
+            }
+            else if (arg == "--tile" && i + 1 < argc) {
+                options.tileSize = std::atoi(argv[++i]);
+                if (options.tileSize <= 0) {
+                    return false;
+                }
+            }
+            else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // A mode configured from the options
+    static std::unique_ptr<GameMode> makeMode(const GenerateOptions& options) {
+        std::unique_ptr<GameMode> mode;
+        if (options.modeName == "easy") {
+            mode.reset(new EasyMode());
+        }
+        else {
+            mode.reset(new HardMode());
+        }
+        mode->setGenerator(options.engine);
+        mode->setGridSize(options.gridSize);
+        mode->setWordCount(options.wordCount);
+        return mode;
+    }
+
+    //------------------------------------------------------------------------------
+    // solveReport
+    // Checks a generated grid with the solver: the distinct words of the
+    // level's length it holds, which should be exactly the placed ones since
+    // the background fill spells none, and the occurrences of words of any
+    // length. With listWords the level's words follow, as hints.
+    //------------------------------------------------------------------------------
+    static std::string solveReport(const GridSolver& solver, const Dictionary& words, const CharGrid& grid, int wordLength, int placed, bool listWords) {
+        std::vector<int> levelWords;
+        long long occurrences = 0;
+        solver.forEachMatch(grid, [&](const WordMatch& match) {
+            ++occurrences;
+            if (static_cast<int>(words.word(match.wordId).length()) == wordLength) {
+                levelWords.push_back(match.wordId);
+            }
+        });
+        std::sort(levelWords.begin(), levelWords.end());
+        levelWords.erase(std::unique(levelWords.begin(), levelWords.end()), levelWords.end());
+
+        std::string text = "Solved: " + std::to_string(levelWords.size()) + " words of length " + std::to_string(wordLength) +
+            (static_cast<int>(levelWords.size()) == placed ? " (as placed)" : " (" + std::to_string(placed) + " placed)") +
+            ", " + std::to_string(occurrences) + " matches of any length";
+        if (listWords) {
+            text += ':';
+            for (int id : levelWords) {
+                text += ' ';
+                text += words.word(id);
+            }
+        }
+        return text;
+    }
+
+    //------------------------------------------------------------------------------
+    // runTiled
+    // Generates a TiledGrid of --size cells per side on every core. Tiles
+    // keep the level's word density unless --words gives a total. Prints the
+    // top-left corner at the level's grid size, then the report, and with
+    // --solve counts the words the solver finds across the tiles.
+    //------------------------------------------------------------------------------
+    static int runTiled(const GenerateOptions& options) {
+        std::unique_ptr<GameMode> settings = makeMode(options);
+        int levelSize = GRID_SIZES[options.level - 1];
+        int size = options.gridSize > 0 ? options.gridSize : levelSize;
+        int tiles = (size + options.tileSize - 1) / std::max(options.tileSize, 1);
+
+        TiledGrid::Settings tiled;
+        tiled.size = size;
+        tiled.tileSize = options.tileSize;
+        tiled.wordLength = settings->getWordLength(options.level);
+        tiled.seed = options.seeded ? options.seed : Random::freshSeed();
+        if (options.wordCount > 0) {
+            tiled.wordsPerTile = static_cast<int>((static_cast<long long>(options.wordCount) + tiles * tiles - 1) / (static_cast<long long>(tiles) * tiles));
+        }
+        else {
+            double perCell = static_cast<double>(settings->getWordCount(options.level)) / (levelSize * levelSize);
+            tiled.wordsPerTile = std::max(1, static_cast<int>(perCell * options.tileSize * options.tileSize + 0.5));
+        }
+
+        try {
+            std::shared_ptr<const Dictionary> words = DictionaryRegistry::instance().get(options.filename);
+            TiledGrid grid(options.tiledPath, words, tiled);
+            PlacementResult result = grid.generateAll(options.threads);
+            if (!options.quiet) {
+                GameMode::printGrid(grid.window(0, 0, std::min(size, levelSize)), std::cout);
+            }
+            std::cout << result << std::endl;
+            if (options.solve) {
+                GridSolver solver(*words);
+                long long levelMatches = 0, occurrences = 0;
+                solver.forEachMatch(grid, [&](const WordMatch& match) {
+                    ++occurrences;
+                    levelMatches += static_cast<int>(words->word(match.wordId).length()) == tiled.wordLength;
+                });
+                std::cout << "Solved: " << levelMatches << " matches of length " << tiled.wordLength << " (" << result.placed << " placed), "
+                    << occurrences << " of any length up to " << grid.halo() + 1 << std::endl;
+            }
+        }
+        catch (const std::exception& e) {
+            std::cout << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    //------------------------------------------------------------------------------
+    // runGenerate
+    // Generates one grid for a mode and level and prints it with its
+    // generation report, then with --solve the solver's check of it.
+    //------------------------------------------------------------------------------
+    static int runGenerate(int argc, char* argv[]) {
+        GenerateOptions options;
+        if (!parseGenerateOptions(argc, argv, 4, options)) {
+            printUsage(argv[0]);
+            return 2;
+        }
+        if (!options.tiledPath.empty()) {
+            return runTiled(options);
+        }
+
+        std::unique_ptr<GameMode> mode = makeMode(options);
+        if (options.seeded) {
+            mode->setSeed(options.seed);
+        }
+        mode->Grid(std::to_string(options.level), options.filename);
+        if (mode->getGrid().empty()) {
+            return 1;
+        }
+        if (!options.quiet) {
+            mode->printGrid();
+        }
+        std::cout << mode->getPlacement() << std::endl;
+        if (options.solve) {
+            try {
+                std::shared_ptr<const Dictionary> words = DictionaryRegistry::instance().get(options.filename);
+                GridSolver solver(*words);
+                std::cout << solveReport(solver, *words, mode->getGrid(), mode->getWordLength(options.level), mode->getPlacement().placed, true) << std::endl;
+            }
+            catch (const std::exception& e) {
+                std::cout << "Error: " << e.what() << std::endl;
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    //------------------------------------------------------------------------------
+    // runBatch
+    // Generates 'count' grids in parallel. Puzzle i is seeded from the batch
+    // seed and i alone, and puzzles are written in order as soon as every
+    // earlier one is done, so the output for a seed is the same byte for
+    // byte on any number of threads. Timing goes to stderr for that reason.
+    // With --solve, one solver built up front checks every puzzle.
+    //------------------------------------------------------------------------------
+    static int runBatch(int argc, char* argv[]) {
+        if (argc < 5) {
+            printUsage(argv[0]);
+            return 2;
+        }
+        int count = std::atoi(argv[4]);
+        GenerateOptions options;
+        if (count < 1 || !parseGenerateOptions(argc, argv, 5, options)) {
+            printUsage(argv[0]);
+            return 2;
+        }
+        std::uint64_t seed = options.seeded ? options.seed : Random::freshSeed();
+
+        std::shared_ptr<const Dictionary> words;
+        try {
+            words = DictionaryRegistry::instance().get(options.filename);
+        }
+        catch (const std::exception& e) {
+            std::cout << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+
+        std::unique_ptr<GameMode> settings = makeMode(options);
+        int gridSize = settings->gridSizeForLevel(options.level);
+        int wordCount = settings->wordCountForLevel(options.level);
+        int wordLength = settings->getWordLength(options.level);
+        std::unique_ptr<GridSolver> solver; // Shared by every worker, it is only read
+        if (options.solve) {
+            solver.reset(new GridSolver(*words));
+        }
+
+        std::vector<std::string> pending(count); // Rendered puzzles not yet written
+        std::vector<char> ready(count, 0);
+        int nextToWrite = 0;
+        std::mutex outputLock;
+        auto started = std::chrono::steady_clock::now();
+
+        parallelFor(count, options.threads, [&](int index) {
+            std::uint64_t puzzleSeed = Random::deriveSeed(seed, static_cast<std::uint64_t>(index));
+            Random random(puzzleSeed);
+            std::unique_ptr<GameMode> mode = makeMode(options);
+            mode->allocateGrid(gridSize);
+            PlacementResult result = mode->populateGrid(*words, wordCount, wordLength, random);
+
+            std::string text = "Puzzle " + std::to_string(index + 1) + " seed " + std::to_string(puzzleSeed) +
+                " placed " + std::to_string(result.placed) + "/" + std::to_string(result.requested) + "\n";
+            if (solver) {
+                text += solveReport(*solver, *words, mode->getGrid(), wordLength, result.placed, !options.quiet) + "\n";
+            }
+            if (!options.quiet) {
+                const CharGrid& grid = mode->getGrid();
+                for (int i = 0; i < grid.size(); ++i) {
+                    text.append(grid.rowData(i), grid.size());
+                    text += '\n';
+                }
+                text += '\n';
+            }
+
+            std::lock_guard<std::mutex> guard(outputLock);
+            pending[index] = std::move(text);
+            ready[index] = 1;
+            while (nextToWrite < count && ready[nextToWrite]) {
+                std::cout << pending[nextToWrite];
+                std::string().swap(pending[nextToWrite]);
+                ++nextToWrite;
+            }
+        });
+        std::cout.flush();
+
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        std::cerr << "Generated " << count << " puzzles from seed " << seed << " in " << milliseconds << " ms" << std::endl;
+        return 0;
+    }
+
+    //------------------------------------------------------------------------------
+    // runServe
+    // Parses the server options and runs the server until it is stopped.
+    //------------------------------------------------------------------------------
+    static int runServe(int argc, char* argv[]) {
+        ServerOptions options;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--host" && i + 1 < argc) {
+                options.host = argv[++i];
+            }
+            else if (arg == "--port" && i + 1 < argc) {
+                options.port = std::atoi(argv[++i]);
+            }
+            else if (arg == "--unix" && i + 1 < argc) {
+                options.unixPath = argv[++i];
+            }
+            else if (arg == "--loops" && i + 1 < argc) {
+                options.loops = std::atoi(argv[++i]);
+            }
+            else {
+                printUsage(argv[0]);
+                return 2;
+            }
+        }
+        return runServer(options);
+    }
+
+    // Resident set of the process in bytes, 0 where it cannot be read
+    static std::size_t residentBytes() {
+#ifdef __linux__
+        std::ifstream statm("/proc/self/statm");
+        std::size_t pages = 0, resident = 0;
+        if (statm >> pages >> resident) {
+            return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        }
+#endif
+        return 0;
+    }
+
+    //------------------------------------------------------------------------------
+    // runFootprint
+    // Measures what a server pays per session: opens 'count' sessions at the
+    // main menu, then takes each into a level the way a client would, and
+    // reports the growth of the resident set per session at both points.
+    // Then parks every session as a snapshot and brings it back, reporting the
+    // snapshot size and the time per save and per restore.
+    //------------------------------------------------------------------------------
+    static int runFootprint(int argc, char* argv[]) {
+        int count = argc > 2 ? std::atoi(argv[2]) : 0;
+        std::string modeName = "easy";
+        int level = 3;
+        for (int i = 3; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--mode" && i + 1 < argc) {
+                modeName = argv[++i];
+            }
+            else if (arg == "--level" && i + 1 < argc) {
+                level = std::atoi(argv[++i]);
+            }
+            else {
+                count = 0;
+            }
+        }
+        if (count < 1 || (modeName != "easy" && modeName != "hard") || level < 1 || level > 3) {
+            printUsage(argv[0]);
+            return 2;
+        }
+        const std::string modeChoice = modeName == "easy" ? "1" : "2";
+
+        std::shared_ptr<const Dictionary> words; // Loaded up front so it is not counted
+        try {
+            words = DictionaryRegistry::instance().get(GameSession::wordListFile(std::stoi(modeChoice)));
+        }
+        catch (const std::exception& e) {
+            std::cout << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        std::vector<std::unique_ptr<GameSession>> sessions;
+        sessions.reserve(count);
+        Random seeds(Random::freshSeed());
+
+        std::size_t base = residentBytes();
+        auto started = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; ++i) {
+            sessions.emplace_back(new GameSession(seeds.next(), false));
+            sessions.back()->start();
+        }
+        std::size_t idle = residentBytes();
+        for (std::unique_ptr<GameSession>& session : sessions) {
+            session->handleLine("a");
+            session->handleLine(modeChoice);
+            session->handleLine(std::to_string(level));
+        }
+        std::size_t playing = residentBytes();
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+        std::cout << "sizeof(GameSession): " << sizeof(GameSession) << " bytes\n";
+        if (base == 0) {
+            std::cout << "Resident memory is not available on this platform" << std::endl;
+            return 0;
+        }
+        std::cout << count << " sessions at the menu: " << (idle - base) / count << " bytes each\n";
+        std::cout << count << " sessions in " << modeName << " level " << level << ": " << (playing - base) / count << " bytes each\n";
+        std::cout << "Resident " << playing / (1024 * 1024) << " MiB after " << milliseconds << " ms" << std::endl;
+
+        std::vector<std::string> snapshots(sessions.size());
+        started = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < sessions.size(); ++i) {
+            sessions[i]->save(snapshots[i]);
+        }
+        double saveMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - started).count();
+        sessions.clear();
+        started = std::chrono::steady_clock::now();
+        try {
+            for (const std::string& snapshot : snapshots) {
+                sessions.emplace_back(new GameSession(0, false));
+                sessions.back()->restore(snapshot.data(), snapshot.size());
+            }
+        }
+        catch (const std::exception& e) {
+            std::cout << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        double restoreMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - started).count();
+        std::cout << "Snapshots: " << snapshots.front().size() << " bytes each, save " << saveMicroseconds / count << " us, restore "
+            << restoreMicroseconds / count << " us" << std::endl;
+        return 0;
+    }
+
+    int runCommandLine(int argc, char* argv[]) {
+        std::string command = argc > 1 ? argv[1] : "";
+        if (command == "--generate") {
+            return runGenerate(argc, argv);
+        }
+        if (command == "--batch") {
+            return runBatch(argc, argv);
+        }
+        if (command == "--serve") {
+            return runServe(argc, argv);
+        }
+        if (command == "--footprint") {
+            return runFootprint(argc, argv);
+        }
+        printUsage(argv[0]);
+        return command == "--help" ? 0 : 2;
+    }
+
+} // namespace WordGame
@@ -0,0 +1,545 @@
+#include "header.h"
+#include "Solver.h"
+#include "Stats.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+namespace WordGame {
+
+    namespace {
+
+        //--------------------------------------------------------------------------
+        // Compiled dictionary layout (little-endian, all offsets from file start):
+        //   FileHeader
+        //   FileBucket[bucketCount]        one per word length, ascending
+        //   records                        per bucket: count * length bytes, sorted
+        //   uint32_t slots[slotCount]      8-byte aligned hash table of word ids
+        // Ids are assigned in record order, so each length owns a contiguous id
+        // range. The table uses 64-bit FNV-1a of the word masked to slotCount
+        // with linear probing; empty slots hold 0xFFFFFFFF.
+        //--------------------------------------------------------------------------
+        const char COMPILED_MAGIC[8] = { 'W', 'G', 'D', 'I', 'C', 'T', '\x1a', '\n' };
+        const std::uint32_t COMPILED_VERSION = 1;
+        const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+        struct FileHeader {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t byteOrder; // BYTE_ORDER_MARK as written by the compiler
+            std::uint32_t wordCount;
+            std::uint32_t bucketCount;
+            std::uint32_t slotCount;
+            std::uint32_t reserved;
+            std::uint64_t bucketsOffset;
+            std::uint64_t slotsOffset;
+            std::uint64_t fileSize;
+        };
+
+        struct FileBucket {
+            std::uint32_t length;
+            std::uint32_t count;
+            std::uint32_t firstId;
+            std::uint32_t reserved;
+            std::uint64_t recordsOffset;
+        };
+
+        static_assert(sizeof(FileHeader) == 56, "FileHeader layout changed");
+        static_assert(sizeof(FileBucket) == 24, "FileBucket layout changed");
+
+        bool isCompiledImage(const MappedFile& file) {
+            return file.size() >= sizeof(FileHeader) && std::memcmp(file.data(), COMPILED_MAGIC, sizeof(COMPILED_MAGIC)) == 0;
+        }
+
+        // Whether [offset, offset + length) lies within size bytes. Both values
+        // come from the file, so the sum is never formed; it could wrap.
+        bool sectionFits(std::uint64_t offset, std::uint64_t length, std::uint64_t size) {
+            return offset <= size && length <= size - offset;
+        }
+
+    } // namespace
+
+    //------------------------------------------------------------------------------
+    // hash
+    // 64-bit FNV-1a over the word's bytes. Compiled files depend on this
+    // function, so it must not change without bumping COMPILED_VERSION.
+    //------------------------------------------------------------------------------
+    std::uint64_t Dictionary::hash(const char* text, std::size_t length) {
+        std::uint64_t value = 14695981039346656037ULL;
+        for (std::size_t i = 0; i < length; ++i) {
+            value ^= static_cast<unsigned char>(text[i]);
+            value *= 1099511628211ULL;
+        }
+        return value;
+    }
+
+    //------------------------------------------------------------------------------
+    // find
+    // Probes linearly from the word's home slot until it meets the word or an
+    // empty slot.
+    //------------------------------------------------------------------------------
+    int Dictionary::find(std::string_view word) const {
+        const std::uint32_t* table = compiled ? compiledSlots : slots.data();
+        std::size_t slotCount = compiled ? compiledSlotCount : slots.size();
+        if (slotCount == 0) {
+            return -1;
+        }
+        std::size_t mask = slotCount - 1;
+        std::uint64_t probes = 0;
+        for (std::size_t slot = hash(word.data(), word.length()) & mask; ; slot = (slot + 1) & mask) {
+            std::uint32_t id = table[slot];
+            ++probes;
+            if (id == EMPTY_SLOT) {
+                WORDGAME_RECORD(DictionaryProbes, probes);
+                return -1;
+            }
+            if (this->word(static_cast<int>(id)) == word) {
+                WORDGAME_RECORD(DictionaryProbes, probes);
+                return static_cast<int>(id);
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // word
+    // Text dictionaries keep a view per id. Compiled ones find the length
+    // bucket holding the id and point into its records.
+    //------------------------------------------------------------------------------
+    std::string_view Dictionary::word(int id) const {
+        if (!compiled) {
+            return words[id];
+        }
+        auto bucketAfter = std::upper_bound(compiledBuckets.begin(), compiledBuckets.end(), id,
+            [](int value, const CompiledBucket& bucket) { return value < bucket.firstId; });
+        const CompiledBucket& bucket = *(bucketAfter - 1);
+        return std::string_view(bucket.records + static_cast<std::size_t>(id - bucket.firstId) * bucket.length, bucket.length);
+    }
+
+    //------------------------------------------------------------------------------
+    // bucket
+    // Returns the ids of every word with the given length.
+    //------------------------------------------------------------------------------
+    WordBucket Dictionary::bucket(int length) const {
+        if (compiled) {
+            for (const CompiledBucket& bucket : compiledBuckets) {
+                if (bucket.length == length) {
+                    return WordBucket{ nullptr, bucket.firstId, bucket.count };
+                }
+            }
+            return WordBucket{ nullptr, 0, 0 };
+        }
+        if (length < 0 || length >= static_cast<int>(lengthIds.size())) {
+            return WordBucket{ nullptr, 0, 0 };
+        }
+        return WordBucket{ lengthIds[length].data(), 0, static_cast<int>(lengthIds[length].size()) };
+    }
+
+    //------------------------------------------------------------------------------
+    // lineAutomaton
+    // Builds the automaton on the first request for a length and hands out
+    // the same one after that. Grids of a level are generated from one
+    // shared dictionary on several threads, so the cache is locked. The first
+    // caller for a length builds outside the lock and others asking for that
+    // length wait on the same future, so a build holds up neither other
+    // lengths nor other dictionaries. A failed build is forgotten so the next
+    // call tries again.
+    //------------------------------------------------------------------------------
+    std::shared_ptr<const AhoCorasick> Dictionary::lineAutomaton(int length) const {
+        std::promise<std::shared_ptr<const AhoCorasick>> built;
+        std::shared_future<std::shared_ptr<const AhoCorasick>> result;
+        bool builder = false;
+        {
+            std::lock_guard<std::mutex> guard(lineAutomataLock);
+            auto found = lineAutomata.find(length);
+            if (found != lineAutomata.end()) {
+                result = found->second;
+            }
+            else {
+                result = built.get_future().share();
+                lineAutomata.emplace(length, result);
+                builder = true;
+            }
+        }
+
+        if (builder) {
+            try {
+                auto automaton = std::make_shared<AhoCorasick>();
+                automaton->buildLines(*this, length);
+                built.set_value(std::move(automaton));
+            }
+            catch (...) {
+                built.set_exception(std::current_exception());
+                std::lock_guard<std::mutex> guard(lineAutomataLock);
+                lineAutomata.erase(length);
+            }
+        }
+        return result.get();
+    }
+
+    Dictionary& Dictionary::operator=(Dictionary&& other) {
+        if (this == &other) {
+            return *this;
+        }
+        words = std::move(other.words);
+        slots = std::move(other.slots);
+        lengthIds = std::move(other.lengthIds);
+        source = std::move(other.source);
+        ownedWords = std::move(other.ownedWords);
+        compiled = other.compiled;
+        compiledWordCount = other.compiledWordCount;
+        compiledSlots = other.compiledSlots;
+        compiledSlotCount = other.compiledSlotCount;
+        compiledBuckets = std::move(other.compiledBuckets);
+        lineAutomata = std::move(other.lineAutomata);
+        other.clear();
+        return *this;
+    }
+
+    //------------------------------------------------------------------------------
+    // load
+    // Maps the file. A compiled file is used as it is; a word list is split on
+    // whitespace in place, and each word becomes a view into the mapping, so
+    // loading does not allocate per word. Storage is sized from the line count
+    // before tokenizing.
+    //------------------------------------------------------------------------------
+    void Dictionary::load(const std::string& filename) {
+        WORDGAME_TIME(LoadWordsTime);
+        std::shared_ptr<const MappedFile> file = MappedFile::open(filename);
+        clear();
+        source = file;
+
+        if (isCompiledImage(*file)) {
+            openCompiled();
+            return;
+        }
+
+        const char* text = file->data();
+        const char* end = text + file->size();
+        reserve(static_cast<std::size_t>(std::count(text, end, '\n')) + 1);
+
+        auto isSpace = [](char ch) {
+            return ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t' || ch == '\v' || ch == '\f';
+        };
+        while (text < end) {
+            while (text < end && isSpace(*text)) {
+                ++text;
+            }
+            const char* start = text;
+            while (text < end && !isSpace(*text)) {
+                ++text;
+            }
+            if (text > start) {
+                insert(std::string_view(start, static_cast<std::size_t>(text - start)), false);
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // openCompiled
+    // Checks the header and every offset against the file size, and every slot
+    // against the word count, then points the lookup tables into the mapping.
+    // Lookups probe until they meet an empty slot, so the table must have one.
+    //------------------------------------------------------------------------------
+    void Dictionary::openCompiled() {
+        const char* base = source->data();
+        std::size_t fileSize = source->size();
+        FileHeader header;
+        std::memcpy(&header, base, sizeof(header));
+
+        if (header.version != COMPILED_VERSION || header.byteOrder != BYTE_ORDER_MARK) {
+            throw std::runtime_error("Unsupported compiled dictionary version or byte order");
+        }
+        if (header.fileSize != fileSize ||
+            !sectionFits(header.bucketsOffset, static_cast<std::uint64_t>(header.bucketCount) * sizeof(FileBucket), fileSize) ||
+            header.slotsOffset % sizeof(std::uint32_t) != 0 ||
+            !sectionFits(header.slotsOffset, static_cast<std::uint64_t>(header.slotCount) * sizeof(std::uint32_t), fileSize) ||
+            header.slotCount == 0 || (header.slotCount & (header.slotCount - 1)) != 0) {
+            throw std::runtime_error("Corrupt compiled dictionary");
+        }
+
+        std::uint32_t expectedId = 0;
+        compiledBuckets.reserve(header.bucketCount);
+        for (std::uint32_t b = 0; b < header.bucketCount; ++b) {
+            FileBucket entry;
+            std::memcpy(&entry, base + header.bucketsOffset + b * sizeof(FileBucket), sizeof(entry));
+            if (entry.firstId != expectedId || entry.length == 0 ||
+                !sectionFits(entry.recordsOffset, static_cast<std::uint64_t>(entry.count) * entry.length, fileSize)) {
+                throw std::runtime_error("Corrupt compiled dictionary");
+            }
+            compiledBuckets.push_back(CompiledBucket{ static_cast<int>(entry.length), static_cast<int>(entry.firstId),
+                static_cast<int>(entry.count), base + entry.recordsOffset });
+            expectedId += entry.count;
+        }
+        if (expectedId != header.wordCount) {
+            throw std::runtime_error("Corrupt compiled dictionary");
+        }
+
+        const std::uint32_t* slotTable = reinterpret_cast<const std::uint32_t*>(base + header.slotsOffset);
+        bool hasEmptySlot = false;
+        for (std::uint32_t s = 0; s < header.slotCount; ++s) {
+            if (slotTable[s] == EMPTY_SLOT) {
+                hasEmptySlot = true;
+            }
+            else if (slotTable[s] >= header.wordCount) {
+                throw std::runtime_error("Corrupt compiled dictionary");
+            }
+        }
+        if (!hasEmptySlot) {
+            throw std::runtime_error("Corrupt compiled dictionary");
+        }
+
+        compiledSlots = slotTable;
+        compiledSlotCount = header.slotCount;
+        compiledWordCount = static_cast<int>(header.wordCount);
+        compiled = true;
+    }
+
+    //------------------------------------------------------------------------------
+    // materialize
+    // Copies a compiled dictionary's views into the editable tables so words
+    // can be added. The mapping stays alive and the views keep pointing into it.
+    //------------------------------------------------------------------------------
+    void Dictionary::materialize() {
+        std::vector<std::string_view> views;
+        views.reserve(compiledWordCount);
+        for (int id = 0; id < compiledWordCount; ++id) {
+            views.push_back(word(id));
+        }
+        compiled = false;
+        compiledSlots = nullptr;
+        compiledSlotCount = 0;
+        compiledWordCount = 0;
+        compiledBuckets.clear();
+        reserve(views.size());
+        for (std::string_view view : views) {
+            insert(view, false);
+        }
+    }
+
+    int Dictionary::add(std::string_view word) {
+        return insert(word, true);
+    }
+
+    //------------------------------------------------------------------------------
+    // insert
+    // Inserts a word unless it is already present. The table is kept at most
+    // half full so probe sequences stay short.
+    //------------------------------------------------------------------------------
+    int Dictionary::insert(std::string_view word, bool copy) {
+        if (compiled) {
+            materialize();
+        }
+        lineAutomata.clear();
+        if ((words.size() + 1) * 2 > slots.size()) {
+            rehash(std::max<std::size_t>(16, slots.size() * 2));
+        }
+        std::size_t mask = slots.size() - 1;
+        std::size_t slot = hash(word.data(), word.length()) & mask;
+        for (; slots[slot] != EMPTY_SLOT; slot = (slot + 1) & mask) {
+            if (words[slots[slot]] == word) {
+                return static_cast<int>(slots[slot]);
+            }
+        }
+        std::uint32_t id = static_cast<std::uint32_t>(words.size());
+        slots[slot] = id;
+        if (copy) {
+            ownedWords.emplace_back(word);
+            word = ownedWords.back();
+        }
+        words.push_back(word);
+        if (lengthIds.size() <= word.length()) {
+            lengthIds.resize(word.length() + 1);
+        }
+        lengthIds[word.length()].push_back(id);
+        return static_cast<int>(id);
+    }
+
+    void Dictionary::reserve(std::size_t count) {
+        words.reserve(count);
+        std::size_t slotCount = 16;
+        while (slotCount < count * 2) {
+            slotCount *= 2;
+        }
+        if (slotCount > slots.size()) {
+            rehash(slotCount);
+        }
+    }
+
+    void Dictionary::clear() {
+        words.clear();
+        slots.clear();
+        lengthIds.clear();
+        source.reset();
+        ownedWords.clear();
+        compiled = false;
+        compiledWordCount = 0;
+        compiledSlots = nullptr;
+        compiledSlotCount = 0;
+        compiledBuckets.clear();
+        lineAutomata.clear();
+    }
+
+    void Dictionary::rehash(std::size_t slotCount) {
+        slots.assign(slotCount, EMPTY_SLOT);
+        std::size_t mask = slotCount - 1;
+        for (std::size_t id = 0; id < words.size(); ++id) {
+            std::size_t slot = hash(words[id].data(), words[id].length()) & mask;
+            while (slots[slot] != EMPTY_SLOT) {
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = static_cast<std::uint32_t>(id);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // writeCompiled
+    // Lowercases, sorts by length then spelling, and drops duplicates before
+    // laying the file out. The file is written beside the target and renamed
+    // over it, so a reader never maps a half-written dictionary.
+    //------------------------------------------------------------------------------
+    void Dictionary::writeCompiled(const std::string& filename, std::vector<std::string> words) {
+        for (std::string& word : words) {
+            for (char& ch : word) {
+                if (ch >= 'A' && ch <= 'Z') {
+                    ch = static_cast<char>(ch - 'A' + 'a');
+                }
+            }
+        }
+        words.erase(std::remove_if(words.begin(), words.end(), [](const std::string& word) { return word.empty(); }), words.end());
+        std::sort(words.begin(), words.end(), [](const std::string& a, const std::string& b) {
+            return a.length() != b.length() ? a.length() < b.length() : a < b;
+        });
+        words.erase(std::unique(words.begin(), words.end()), words.end());
+        if (words.size() >= EMPTY_SLOT) {
+            throw std::runtime_error("Too many words for a compiled dictionary");
+        }
+
+        std::vector<FileBucket> buckets;
+        for (std::size_t id = 0; id < words.size(); ++id) {
+            if (buckets.empty() || buckets.back().length != words[id].length()) {
+                buckets.push_back(FileBucket{ static_cast<std::uint32_t>(words[id].length()), 0, static_cast<std::uint32_t>(id), 0, 0 });
+            }
+            ++buckets.back().count;
+        }
+
+        std::uint32_t slotCount = 16;
+        while (slotCount < words.size() * 2) {
+            slotCount *= 2;
+        }
+        std::vector<std::uint32_t> table(slotCount, EMPTY_SLOT);
+        for (std::size_t id = 0; id < words.size(); ++id) {
+            std::size_t slot = hash(words[id].data(), words[id].length()) & (slotCount - 1);
+            while (table[slot] != EMPTY_SLOT) {
+                slot = (slot + 1) & (slotCount - 1);
+            }
+            table[slot] = static_cast<std::uint32_t>(id);
+        }
+
+        FileHeader header;
+        std::memcpy(header.magic, COMPILED_MAGIC, sizeof(COMPILED_MAGIC));
+        header.version = COMPILED_VERSION;
+        header.byteOrder = BYTE_ORDER_MARK;
+        header.wordCount = static_cast<std::uint32_t>(words.size());
+        header.bucketCount = static_cast<std::uint32_t>(buckets.size());
+        header.slotCount = slotCount;
+        header.reserved = 0;
+        header.bucketsOffset = sizeof(FileHeader);
+        std::uint64_t offset = header.bucketsOffset + buckets.size() * sizeof(FileBucket);
+        for (FileBucket& bucket : buckets) {
+            bucket.recordsOffset = offset;
+            offset += static_cast<std::uint64_t>(bucket.count) * bucket.length;
+        }
+        std::uint64_t padding = (8 - offset % 8) % 8;
+        header.slotsOffset = offset + padding;
+        header.fileSize = header.slotsOffset + static_cast<std::uint64_t>(slotCount) * sizeof(std::uint32_t);
+
+        std::string tempName = filename + ".tmp";
+        {
+            std::ofstream out(tempName, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) {
+                throw std::runtime_error("Could not open file " + tempName + " for writing");
+            }
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(buckets.data()), buckets.size() * sizeof(FileBucket));
+            for (const std::string& word : words) {
+                out.write(word.data(), word.length());
+            }
+            const char zeros[8] = {};
+            out.write(zeros, padding);
+            out.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(std::uint32_t));
+            if (!out) {
+                throw std::runtime_error("Could not write file " + tempName);
+            }
+        }
+        if (std::rename(tempName.c_str(), filename.c_str()) != 0) {
+            std::remove(filename.c_str());
+            if (std::rename(tempName.c_str(), filename.c_str()) != 0) {
+                throw std::runtime_error("Could not replace file " + filename);
+            }
+        }
+    }
+
+    DictionaryRegistry& DictionaryRegistry::instance() {
+        static DictionaryRegistry registry;
+        return registry;
+    }
+
+    //------------------------------------------------------------------------------
+    // get
+    // Returns the cached dictionary while the file's time and size still match.
+    // Otherwise the first caller loads it outside the lock and everyone else
+    // asking meanwhile waits on the same future. A failed load is forgotten
+    // so the next call tries again.
+    //------------------------------------------------------------------------------
+    std::shared_ptr<const Dictionary> DictionaryRegistry::get(const std::string& path) {
+        std::error_code error;
+        std::int64_t modified = 0;
+        auto writeTime = std::filesystem::last_write_time(path, error);
+        if (!error) {
+            modified = static_cast<std::int64_t>(writeTime.time_since_epoch().count());
+        }
+        std::uintmax_t fileSize = std::filesystem::file_size(path, error);
+        if (error) {
+            fileSize = 0;
+        }
+
+        std::promise<std::shared_ptr<const Dictionary>> loaded;
+        std::shared_future<std::shared_ptr<const Dictionary>> result;
+        bool loader = false;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            auto found = entries.find(path);
+            if (found != entries.end() && found->second.modified == modified && found->second.fileSize == fileSize) {
+                result = found->second.dictionary;
+            }
+            else {
+                result = loaded.get_future().share();
+                entries[path] = Entry{ modified, fileSize, result };
+                loader = true;
+            }
+        }
+
+        if (loader) {
+            try {
+                std::shared_ptr<Dictionary> dictionary = std::make_shared<Dictionary>();
+                dictionary->load(path);
+                loaded.set_value(std::move(dictionary));
+            }
+            catch (...) {
+                loaded.set_exception(std::current_exception());
+                std::lock_guard<std::mutex> guard(lock);
+                auto found = entries.find(path);
+                if (found != entries.end() && found->second.modified == modified && found->second.fileSize == fileSize) {
+                    entries.erase(found);
+                }
+            }
+        }
+        return result.get();
+    }
+
+    void DictionaryRegistry::clear() {
+        std::lock_guard<std::mutex> guard(lock);
+        entries.clear();
+    }
+
+} // namespace WordGame
@@ -0,0 +1,237 @@
+#include "header.h"
+#include <unordered_map>
+
+namespace WordGame {
+
+    //------------------------------------------------------------------------------
+    // operator<< for PlacementResult
+    // Prints the generation report used by the command line tools.
+    //------------------------------------------------------------------------------
+    std::ostream& operator<<(std::ostream& out, const PlacementResult& result) {
+        out << "placed " << result.placed << "/" << result.requested
+            << " (" << static_cast<int>(result.successRate() * 100.0 + 0.5) << "%)"
+            << ", attempts " << result.attempts
+            << ", backtracks " << result.backtracks
+            << ", density " << static_cast<int>(result.density * 100.0 + 0.5) << "%"
+            << ", " << result.milliseconds << " ms";
+        return out;
+    }
+
+    //------------------------------------------------------------------------------
+    // legalPlacements
+    // Lists the starts and directions where the word fits: inside the grid,
+    // agreeing with every letter it crosses, and adding at least one new cell.
+    // Stops once more than 'limit' are found, since the caller only needs to
+    // know the word is less constrained than its best candidate; the scan
+    // starts at a random cell so a cut-off list is not biased to the top rows.
+    // Grids over 32x32 only try a random sample of 1024 starts per call, which
+    // keeps a step's cost independent of grid area.
+    //------------------------------------------------------------------------------
+    std::vector<BacktrackingGenerator::Option> BacktrackingGenerator::legalPlacements(std::string_view word, std::size_t limit) const {
+        const int sampleLimit = 1024;
+        int size = grid.size();
+        int wordLen = static_cast<int>(word.length());
+        std::vector<Option> options;
+
+        auto tryStart = [&](int row, int col) {
+            for (int d = 0; d < NUM_DIRECTIONS; ++d) {
+                int dRow = DIRECTION_ROW[d], dCol = DIRECTION_COL[d];
+                if (!grid.inBounds(row + (wordLen - 1) * dRow, col + (wordLen - 1) * dCol)) {
+                    continue;
+                }
+                int crossings = 0;
+                bool fits = true;
+                for (int k = 0; k < wordLen; ++k) {
+                    char cell = grid.at(row + k * dRow, col + k * dCol);
+                    if (cell == word[k]) {
+                        ++crossings;
+                    }
+                    else if (cell != ' ') {
+                        fits = false;
+                        break;
+                    }
+                }
+                if (fits && crossings < wordLen) {
+                    options.push_back(Option{ row, col, d, crossings });
+                }
+            }
+            return options.size() <= limit;
+        };
+
+        int area = size * size;
+        if (area <= sampleLimit) {
+            int first = area > 0 ? random.below(area) : 0;
+            for (int c = 0; c < area; ++c) {
+                int cell = (first + c) % area;
+                if (!tryStart(cell / size, cell % size)) {
+                    return options;
+                }
+            }
+        }
+        else {
+            for (int s = 0; s < sampleLimit; ++s) {
+                if (!tryStart(random.below(size), random.below(size))) {
+                    return options;
+                }
+            }
+        }
+        return options;
+    }
+
+    void BacktrackingGenerator::apply(Frame& frame) {
+        const Option& option = frame.options[frame.next];
+        std::string_view word = words.word(frame.wordId);
+        frame.written.clear();
+        for (int k = 0; k < wordLength; ++k) {
+            int row = option.row + k * DIRECTION_ROW[option.direction];
+            int col = option.col + k * DIRECTION_COL[option.direction];
+            if (grid.at(row, col) == ' ') {
+                grid.set(row, col, word[k]);
+                frame.written.push_back(row * grid.size() + col);
+            }
+        }
+    }
+
+    void BacktrackingGenerator::undo(Frame& frame) {
+        for (int cell : frame.written) {
+            grid.set(cell / grid.size(), cell % grid.size(), ' ');
+        }
+        frame.written.clear();
+    }
+
+    //------------------------------------------------------------------------------
+    // run
+    // Each step scores a small pool of unplaced words by how many legal
+    // placements they have and commits the most constrained one at its
+    // placement with the most crossings (ties broken randomly). Words with no
+    // placement are set aside. When a whole pool is set aside, or the bucket
+    // runs dry, the search undoes the latest word and moves it to its next
+    // placement, then gives the set-aside words another chance. Every pool
+    // evaluation counts as an attempt against a budget, so the search always
+    // ends. If it ends short of the target, the deepest assignment it reached
+    // is restored.
+    //------------------------------------------------------------------------------
+    PlacementResult BacktrackingGenerator::run(int targetWordCount) {
+        const std::size_t poolSize = 8;
+        const std::size_t maxOptions = 16;
+        const int attemptBudget = 1000 + 50 * targetWordCount;
+        const std::size_t stuckLimit = 4 * poolSize;
+        const std::size_t openLimit = 4 * maxOptions; // More placements than this count as unconstrained
+
+        PlacementResult result = { 0, targetWordCount, 0, 0, 0.0, 0.0 };
+        WordBucket bucket = words.bucket(wordLength);
+        int remaining = (wordLength > 0 && wordLength <= grid.size()) ? bucket.count : 0;
+        std::unordered_map<int, int> swapped; // Sparse Fisher-Yates over bucket positions
+
+        auto draw = [&]() {
+            auto at = [&](int position) {
+                auto found = swapped.find(position);
+                return found == swapped.end() ? position : found->second;
+            };
+            int slot = random.below(remaining);
+            int position = at(slot);
+            swapped[slot] = at(remaining - 1);
+            --remaining;
+            return bucket.id(position);
+        };
+
+        std::vector<int> pool; // Word ids waiting to be scored
+        std::vector<int> setAside; // Word ids that had no placement
+        std::vector<Frame> stack; // Placed words, in order
+        std::vector<std::pair<int, Option>> deepest; // Largest assignment seen so far
+
+        auto backtrack = [&]() {
+            while (!stack.empty()) {
+                Frame& top = stack.back();
+                undo(top);
+                ++result.backtracks;
+                if (++top.next < top.options.size()) {
+                    apply(top);
+                    pool.insert(pool.end(), setAside.begin(), setAside.end());
+                    setAside.clear();
+                    return true;
+                }
+                stack.pop_back(); // Out of placements, the word is dropped
+            }
+            return false;
+        };
+
+        while (static_cast<int>(stack.size()) < targetWordCount && result.attempts < attemptBudget) {
+            while (pool.size() < poolSize && remaining > 0) {
+                pool.push_back(draw());
+            }
+            if (pool.empty() && setAside.empty()) {
+                break; // Every word of this length is placed
+            }
+            if (pool.empty()) {
+                if (!backtrack()) {
+                    break;
+                }
+                continue;
+            }
+
+            // Most constrained word in the pool
+            int bestWord = -1;
+            std::vector<Option> bestOptions;
+            for (std::size_t p = 0; p < pool.size() && result.attempts < attemptBudget; ) {
+                ++result.attempts;
+                std::size_t limit = bestWord < 0 ? openLimit : bestOptions.size();
+                std::vector<Option> options = legalPlacements(words.word(pool[p]), limit);
+                if (options.empty()) {
+                    setAside.push_back(pool[p]);
+                    pool[p] = pool.back();
+                    pool.pop_back();
+                    continue;
+                }
+                if (bestWord < 0 || options.size() < bestOptions.size()) {
+                    bestWord = pool[p];
+                    bestOptions = std::move(options);
+                }
+                ++p;
+            }
+
+            if (bestWord < 0) {
+                if (setAside.size() >= stuckLimit || remaining == 0) {
+                    if (!backtrack()) {
+                        break;
+                    }
+                }
+                continue;
+            }
+
+            // Most crossings first, random among equals
+            for (std::size_t k = bestOptions.size(); k > 1; --k) {
+                std::swap(bestOptions[k - 1], bestOptions[random.below(static_cast<int>(k))]);
+            }
+            std::size_t keep = std::min(maxOptions, bestOptions.size());
+            std::partial_sort(bestOptions.begin(), bestOptions.begin() + keep, bestOptions.end(),
+                [](const Option& a, const Option& b) { return a.crossings > b.crossings; });
+            bestOptions.resize(keep);
+
+            stack.push_back(Frame{ bestWord, std::move(bestOptions), 0, {} });
+            pool.erase(std::find(pool.begin(), pool.end(), bestWord));
+            apply(stack.back());
+
+            if (stack.size() > deepest.size()) {
+                deepest.clear();
+                for (const Frame& frame : stack) {
+                    deepest.emplace_back(frame.wordId, frame.options[frame.next]);
+                }
+            }
+        }
+
+        if (stack.size() < deepest.size()) {
+            for (auto frame = stack.rbegin(); frame != stack.rend(); ++frame) {
+                undo(*frame);
+            }
+            stack.clear();
+            for (const auto& placed : deepest) {
+                stack.push_back(Frame{ placed.first, { placed.second }, 0, {} });
+                apply(stack.back());
+            }
+        }
+        result.placed = static_cast<int>(stack.size());
+        return result;
+    }
+
+} // namespace WordGame
@@ -0,0 +1,162 @@
+#include "header.h"
+#include "Stats.h"
+
+namespace WordGame {
+
+    //------------------------------------------------------------------------------
+    // build
+    // Two passes over the grid: the first counts each letter and bigram, the
+    // second writes cell numbers into the slices laid out by the counts.
+    // Cells that do not hold a letter are left out.
+    //------------------------------------------------------------------------------
+    void GridIndex::build(const CharGrid& grid) {
+        int size = grid.size();
+        if (static_cast<std::uint64_t>(size) * size * NUM_DIRECTIONS > UINT32_MAX) {
+            throw std::runtime_error("Grid too large to index");
+        }
+
+        letterOffsets.assign(ALPHABET_SIZE + 1, 0);
+        bigramOffsets.assign(NUM_BIGRAMS + 1, 0);
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                int first = letterIndex(grid.at(i, j));
+                if (first < 0) {
+                    continue;
+                }
+                ++letterOffsets[first + 1];
+                for (int d = 0; d < NUM_DIRECTIONS; ++d) {
+                    int i2 = i + DIRECTION_ROW[d], j2 = j + DIRECTION_COL[d];
+                    if (!grid.inBounds(i2, j2)) {
+                        continue;
+                    }
+                    int second = letterIndex(grid.at(i2, j2));
+                    if (second >= 0) {
+                        ++bigramOffsets[first * ALPHABET_SIZE + second + 1];
+                    }
+                }
+            }
+        }
+        for (int k = 0; k < ALPHABET_SIZE; ++k) {
+            letterOffsets[k + 1] += letterOffsets[k];
+        }
+        for (int k = 0; k < NUM_BIGRAMS; ++k) {
+            bigramOffsets[k + 1] += bigramOffsets[k];
+        }
+
+        letterCells.resize(letterOffsets[ALPHABET_SIZE]);
+        bigramStarts.resize(bigramOffsets[NUM_BIGRAMS]);
+        std::vector<std::uint32_t> letterNext(letterOffsets.begin(), letterOffsets.end() - 1);
+        std::vector<std::uint32_t> bigramNext(bigramOffsets.begin(), bigramOffsets.end() - 1);
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                int first = letterIndex(grid.at(i, j));
+                if (first < 0) {
+                    continue;
+                }
+                std::uint32_t cell = static_cast<std::uint32_t>(i) * size + j;
+                letterCells[letterNext[first]++] = cell;
+                for (int d = 0; d < NUM_DIRECTIONS; ++d) {
+                    int i2 = i + DIRECTION_ROW[d], j2 = j + DIRECTION_COL[d];
+                    if (!grid.inBounds(i2, j2)) {
+                        continue;
+                    }
+                    int second = letterIndex(grid.at(i2, j2));
+                    if (second >= 0) {
+                        bigramStarts[bigramNext[first * ALPHABET_SIZE + second]++] = cell * NUM_DIRECTIONS + d;
+                    }
+                }
+            }
+        }
+        indexedSize = size;
+    }
+
+    void GridIndex::clear() {
+        indexedSize = 0;
+        letterOffsets.clear();
+        letterCells.clear();
+        bigramOffsets.clear();
+        bigramStarts.clear();
+    }
+
+    //------------------------------------------------------------------------------
+    // find
+    // Single letters come from the letter table. Longer words walk the slice of
+    // their first bigram, skip starts whose last cell would fall off the grid,
+    // and compare the remaining letters against the grid.
+    //------------------------------------------------------------------------------
+    bool GridIndex::find(const std::string& word, const CharGrid& grid, WordMatch& match) const {
+        int wordLen = static_cast<int>(word.length());
+        if (empty() || wordLen == 0 || grid.size() != indexedSize) {
+            return false;
+        }
+        int first = letterIndex(word[0]);
+        if (first < 0) {
+            return false;
+        }
+
+        if (wordLen == 1) {
+            for (std::uint32_t k = letterOffsets[first]; k < letterOffsets[first + 1]; ++k) {
+                int row = static_cast<int>(letterCells[k] / indexedSize);
+                int col = static_cast<int>(letterCells[k] % indexedSize);
+                if (letterIndex(grid.at(row, col)) == first) {
+                    match = WordMatch{ row, col, 0, -1 };
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        int second = letterIndex(word[1]);
+        if (second < 0) {
+            return false;
+        }
+        int bigram = first * ALPHABET_SIZE + second;
+        std::uint64_t cellsProbed = 0, directionsProbed = 0;
+        for (std::uint32_t k = bigramOffsets[bigram]; k < bigramOffsets[bigram + 1]; ++k) {
+            std::uint32_t cell = bigramStarts[k] / NUM_DIRECTIONS;
+            int d = static_cast<int>(bigramStarts[k] % NUM_DIRECTIONS);
+            int row = static_cast<int>(cell / indexedSize);
+            int col = static_cast<int>(cell % indexedSize);
+            int dRow = DIRECTION_ROW[d], dCol = DIRECTION_COL[d];
+            if (!grid.inBounds(row + (wordLen - 1) * dRow, col + (wordLen - 1) * dCol)) {
+                continue;
+            }
+
+            bool found = true;
+            ++directionsProbed;
+            for (int m = 0; m < wordLen; ++m) {
+                ++cellsProbed;
+                if (std::tolower(word[m]) != std::tolower(grid.at(row + m * dRow, col + m * dCol))) {
+                    found = false;
+                    break;
+                }
+            }
+            if (found) {
+                WORDGAME_RECORD(SearchCellsProbed, cellsProbed);
+                WORDGAME_RECORD(SearchDirectionsProbed, directionsProbed);
+                match = WordMatch{ row, col, d, -1 };
+                return true;
+            }
+        }
+        WORDGAME_RECORD(SearchCellsProbed, cellsProbed);
+        WORDGAME_RECORD(SearchDirectionsProbed, directionsProbed);
+        return false;
+    }
+
+    std::size_t GridIndex::letterCount(char ch) const {
+        int letter = letterIndex(ch);
+        if (empty() || letter < 0) {
+            return 0;
+        }
+        return letterOffsets[letter + 1] - letterOffsets[letter];
+    }
+
+    std::size_t GridIndex::bigramCount(char first, char second) const {
+        int a = letterIndex(first), b = letterIndex(second);
+        if (empty() || a < 0 || b < 0) {
+            return 0;
+        }
+        return bigramOffsets[a * ALPHABET_SIZE + b + 1] - bigramOffsets[a * ALPHABET_SIZE + b];
+    }
+
+} // namespace WordGame
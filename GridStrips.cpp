@@ -0,0 +1,293 @@
+#include "header.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define WORDGAME_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define WORDGAME_HAVE_AVX2 1
+#define WORDGAME_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(__AVX2__)
+#define WORDGAME_HAVE_AVX2 1
+#define WORDGAME_TARGET_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace WordGame {
+
+    namespace {
+
+        // Position of the lowest set bit of a non-zero mask
+        inline unsigned lowestBit(unsigned mask) {
+#if defined(_MSC_VER)
+            unsigned long bit;
+            _BitScanForward(&bit, mask);
+            return static_cast<unsigned>(bit);
+#else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+        }
+
+        //--------------------------------------------------------------------------
+        // findScalar
+        // Portable search: memchr to the next first letter, then compare the last
+        // letter before the rest of the needle.
+        //--------------------------------------------------------------------------
+        std::size_t findScalar(const char* text, std::size_t length, const char* needle, std::size_t needleLength, std::size_t from) {
+            if (needleLength == 0 || length < needleLength) {
+                return length;
+            }
+            std::size_t lastStart = length - needleLength;
+            while (from <= lastStart) {
+                const void* hit = std::memchr(text + from, needle[0], lastStart - from + 1);
+                if (hit == nullptr) {
+                    break;
+                }
+                std::size_t i = static_cast<const char*>(hit) - text;
+                if (text[i + needleLength - 1] == needle[needleLength - 1] &&
+                    std::memcmp(text + i, needle, needleLength) == 0) {
+                    return i;
+                }
+                from = i + 1;
+            }
+            return length;
+        }
+
+#ifdef WORDGAME_HAVE_SSE2
+        //--------------------------------------------------------------------------
+        // findSse2
+        // Compares 16 candidate starts at once against the needle's first letter
+        // and, at the matching offset, its last letter. Only starts that pass
+        // both are checked with memcmp. The tail falls back to findScalar.
+        //--------------------------------------------------------------------------
+        std::size_t findSse2(const char* text, std::size_t length, const char* needle, std::size_t needleLength, std::size_t from) {
+            if (needleLength == 0 || length < needleLength) {
+                return length;
+            }
+            const __m128i first = _mm_set1_epi8(needle[0]);
+            const __m128i last = _mm_set1_epi8(needle[needleLength - 1]);
+            std::size_t i = from;
+            for (; i + needleLength - 1 + 16 <= length; i += 16) {
+                __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+                __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + needleLength - 1));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+                    _mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last))));
+                while (mask != 0) {
+                    unsigned bit = lowestBit(mask);
+                    if (needleLength <= 2 || std::memcmp(text + i + bit + 1, needle + 1, needleLength - 2) == 0) {
+                        return i + bit;
+                    }
+                    mask &= mask - 1;
+                }
+            }
+            return findScalar(text, length, needle, needleLength, i);
+        }
+#endif
+
+#ifdef WORDGAME_HAVE_AVX2
+        // Same filter as findSse2 over 32 starts per step
+        WORDGAME_TARGET_AVX2
+        std::size_t findAvx2(const char* text, std::size_t length, const char* needle, std::size_t needleLength, std::size_t from) {
+            if (needleLength == 0 || length < needleLength) {
+                return length;
+            }
+            const __m256i first = _mm256_set1_epi8(needle[0]);
+            const __m256i last = _mm256_set1_epi8(needle[needleLength - 1]);
+            std::size_t i = from;
+            for (; i + needleLength - 1 + 32 <= length; i += 32) {
+                __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+                __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + needleLength - 1));
+                unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+                    _mm256_and_si256(_mm256_cmpeq_epi8(head, first), _mm256_cmpeq_epi8(tail, last))));
+                while (mask != 0) {
+                    unsigned bit = lowestBit(mask);
+                    if (needleLength <= 2 || std::memcmp(text + i + bit + 1, needle + 1, needleLength - 2) == 0) {
+                        return i + bit;
+                    }
+                    mask &= mask - 1;
+                }
+            }
+            return findScalar(text, length, needle, needleLength, i);
+        }
+#endif
+
+        using FindFunction = std::size_t (*)(const char*, std::size_t, const char*, std::size_t, std::size_t);
+
+        // Picks the widest kernel the CPU supports, once
+        FindFunction selectFind() {
+#if defined(WORDGAME_HAVE_AVX2) && defined(__GNUC__) && !defined(__AVX2__)
+            if (__builtin_cpu_supports("avx2")) {
+                return findAvx2;
+            }
+#elif defined(WORDGAME_HAVE_AVX2)
+            return findAvx2;
+#endif
+#ifdef WORDGAME_HAVE_SSE2
+            return findSse2;
+#else
+            return findScalar;
+#endif
+        }
+
+    } // namespace
+
+    std::size_t GridStrips::findSubstring(const char* text, std::size_t length, const char* needle, std::size_t needleLength, std::size_t from) {
+        static const FindFunction kernel = selectFind();
+        return kernel(text, length, needle, needleLength, from);
+    }
+
+    //------------------------------------------------------------------------------
+    // build
+    // Lays out each family's strips back to back, recording where every strip
+    // starts in the buffer and in the grid. The reversed buffer is the forward
+    // one read end to end, so offset p there is offset N - 1 - p here.
+    //------------------------------------------------------------------------------
+    void GridStrips::build(const CharGrid& grid) {
+        int size = grid.size();
+        if (static_cast<std::uint64_t>(size) * size + 2 * static_cast<std::uint64_t>(size) > UINT32_MAX) {
+            throw std::runtime_error("Grid too large for strip layout");
+        }
+
+        const int forwardDirection[NUM_STRIP_FAMILIES] = { 0, 2, 4, 5 }; // Right, Down, Down-right, Up-right
+        const int reverseDirection[NUM_STRIP_FAMILIES] = { 1, 3, 7, 6 }; // Left, Up, Up-left, Down-left
+
+        for (int f = 0; f < NUM_STRIP_FAMILIES; ++f) {
+            Family& family = families[f];
+            family.direction = forwardDirection[f];
+            family.reverse = reverseDirection[f];
+            family.forward.clear();
+            family.stripOffsets.clear();
+            family.stripCells.clear();
+            int dRow = DIRECTION_ROW[family.direction], dCol = DIRECTION_COL[family.direction];
+
+            auto addStrip = [&](int row, int col, int length) {
+                family.stripOffsets.push_back(static_cast<std::uint32_t>(family.forward.size()));
+                family.stripCells.push_back(static_cast<std::uint32_t>(row) * size + col);
+                for (int k = 0; k < length; ++k) {
+                    char ch = grid.at(row + k * dRow, col + k * dCol);
+                    int letter = letterIndex(ch);
+                    family.forward.push_back(letter < 0 ? ch : static_cast<char>('a' + letter));
+                }
+                family.forward.push_back('\0');
+            };
+
+            if (f == 0) {
+                for (int i = 0; i < size; ++i) addStrip(i, 0, size);
+            }
+            else if (f == 1) {
+                for (int j = 0; j < size; ++j) addStrip(0, j, size);
+            }
+            else if (f == 2) {
+                for (int start = -(size - 1); start < size; ++start) {
+                    int row = start < 0 ? -start : 0;
+                    int col = start < 0 ? 0 : start;
+                    addStrip(row, col, size - std::max(row, col));
+                }
+            }
+            else {
+                for (int sum = 0; sum < 2 * size - 1; ++sum) {
+                    int row = std::min(sum, size - 1);
+                    int col = sum - row;
+                    addStrip(row, col, std::min(row, size - 1 - col) + 1);
+                }
+            }
+            family.backward.assign(family.forward.rbegin(), family.forward.rend());
+        }
+        indexedSize = size;
+    }
+
+    void GridStrips::clear() {
+        indexedSize = 0;
+        for (Family& family : families) {
+            family.forward.clear();
+            family.backward.clear();
+            family.stripOffsets.clear();
+            family.stripCells.clear();
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // locate
+    // Turns a match offset in a family buffer into the cell of the word's first
+    // letter and the direction the word runs in.
+    //------------------------------------------------------------------------------
+    WordMatch GridStrips::locate(const Family& family, std::size_t position, bool reversed) const {
+        std::size_t offset = reversed ? family.forward.size() - 1 - position : position;
+        auto strip = std::upper_bound(family.stripOffsets.begin(), family.stripOffsets.end(), static_cast<std::uint32_t>(offset)) - 1;
+        int k = static_cast<int>(offset - *strip);
+        std::uint32_t cell = family.stripCells[strip - family.stripOffsets.begin()];
+        int row = static_cast<int>(cell / indexedSize) + k * DIRECTION_ROW[family.direction];
+        int col = static_cast<int>(cell % indexedSize) + k * DIRECTION_COL[family.direction];
+        return WordMatch{ row, col, reversed ? family.reverse : family.direction, -1 };
+    }
+
+    //------------------------------------------------------------------------------
+    // scan
+    // Runs the substring search over every forward and reversed buffer.
+    // Single letters are only reported from the forward rows, since every
+    // other buffer holds the same cells again.
+    //------------------------------------------------------------------------------
+    template <typename Fn>
+    bool GridStrips::scan(const std::string& word, Fn&& fn) const {
+        std::size_t wordLen = word.length();
+        if (empty() || wordLen == 0) {
+            return true;
+        }
+        std::string needle(word);
+        for (char& ch : needle) {
+            ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+        }
+
+        int familyCount = wordLen == 1 ? 1 : NUM_STRIP_FAMILIES;
+        for (int f = 0; f < familyCount; ++f) {
+            const Family& family = families[f];
+            for (int pass = 0; pass < (wordLen == 1 ? 1 : 2); ++pass) {
+                const std::vector<char>& text = pass == 0 ? family.forward : family.backward;
+                std::size_t pos = findSubstring(text.data(), text.size(), needle.data(), wordLen, 0);
+                while (pos < text.size()) {
+                    if (!fn(locate(family, pos, pass == 1))) {
+                        return false;
+                    }
+                    pos = findSubstring(text.data(), text.size(), needle.data(), wordLen, pos + 1);
+                }
+            }
+        }
+        return true;
+    }
+
+    std::vector<WordMatch> GridStrips::findAll(const std::string& word) const {
+        std::vector<WordMatch> matches;
+        scan(word, [&](const WordMatch& match) {
+            matches.push_back(match);
+            return true;
+        });
+        return matches;
+    }
+
+    //------------------------------------------------------------------------------
+    // find
+    // Returns the first strip match. The grid is never written after build(),
+    // so a strip match needs no second look at its cells; the grid is only
+    // checked to be the one the strips were built from.
+    //------------------------------------------------------------------------------
+    bool GridStrips::find(const std::string& word, const CharGrid& grid, WordMatch& match) const {
+        if (grid.size() != indexedSize) {
+            return false;
+        }
+        bool found = false;
+        scan(word, [&](const WordMatch& candidate) {
+            match = candidate;
+            found = true;
+            return false;
+        });
+        return found;
+    }
+
+} // namespace WordGame
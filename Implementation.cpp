@@ -1,179 +1,468 @@
 #include "header.h"
+#include "Kernels.h"
+#include "Solver.h"
+#include "Stats.h"
+#include <atomic>
+#include <unordered_map>
 
 namespace WordGame {
 
     //------------------------------------------------------------------------------
-    // Game constructor
+    // GridPool
+    // Keeps released grid buffers on per-size-class free lists. A request is
+    // rounded up to the next power of two so buffers from one level can serve
+    // the next one, and so that shrinking back to a small grid never allocates.
     //------------------------------------------------------------------------------
-    Game::Game() : chances(MAX_CHANCES) {
-        srand(static_cast<unsigned int>(time(0)));
+    GridPool& GridPool::instance() {
+        static GridPool pool;
+        return pool;
+    }
+
+    char* GridPool::acquire(std::size_t bytes, std::size_t& capacity) {
+        int sizeClass = 0;
+        while ((static_cast<std::size_t>(1) << sizeClass) < bytes) {
+            ++sizeClass;
+        }
+        if (sizeClass >= NUM_CLASSES) {
+            throw std::bad_alloc();
+        }
+        capacity = static_cast<std::size_t>(1) << sizeClass;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (!freeLists[sizeClass].empty()) {
+                char* buffer = freeLists[sizeClass].back();
+                freeLists[sizeClass].pop_back();
+                return buffer;
+            }
+        }
+        return static_cast<char*>(::operator new(capacity, std::align_val_t(CACHE_LINE_SIZE)));
+    }
+
+    void GridPool::release(char* buffer, std::size_t capacity) {
+        if (buffer == nullptr) {
+            return;
+        }
+        int sizeClass = 0;
+        while ((static_cast<std::size_t>(1) << sizeClass) < capacity) {
+            ++sizeClass;
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        freeLists[sizeClass].push_back(buffer);
+    }
+
+    void GridPool::trim() {
+        std::lock_guard<std::mutex> guard(lock);
+        for (int i = 0; i < NUM_CLASSES; ++i) {
+            for (char* buffer : freeLists[i]) {
+                ::operator delete(buffer, std::align_val_t(CACHE_LINE_SIZE));
+            }
+            freeLists[i].clear();
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // CharGrid
+    // Copy, move and resize. Owned storage always comes from GridPool; a view
+    // has no capacity, so release() leaves its cells alone and reset() swaps
+    // them for pooled ones.
+    //------------------------------------------------------------------------------
+    CharGrid::CharGrid(const CharGrid& other) : CharGrid() {
+        if (!other.empty()) {
+            cells = GridPool::instance().acquire(other.rowStride * other.gridSize, capacity);
+            gridSize = other.gridSize;
+            rowStride = other.rowStride;
+            std::copy(other.cells, other.cells + rowStride * gridSize, cells);
+        }
+    }
+
+    CharGrid CharGrid::view(char* cells, int size, std::size_t stride) {
+        CharGrid grid;
+        grid.cells = cells;
+        grid.gridSize = size;
+        grid.rowStride = stride;
+        return grid;
+    }
+
+    CharGrid::CharGrid(CharGrid&& other) noexcept
+        : cells(other.cells), gridSize(other.gridSize), rowStride(other.rowStride), capacity(other.capacity) {
+        other.cells = nullptr;
+        other.gridSize = 0;
+        other.rowStride = 0;
+        other.capacity = 0;
+    }
+
+    CharGrid& CharGrid::operator=(CharGrid other) noexcept {
+        std::swap(cells, other.cells);
+        std::swap(gridSize, other.gridSize);
+        std::swap(rowStride, other.rowStride);
+        std::swap(capacity, other.capacity);
+        return *this;
+    }
+
+    void CharGrid::reset(int size, bool padRows) {
+        if (size <= 0) {
+            throw std::invalid_argument("Grid size must be positive");
+        }
+        std::size_t newStride = static_cast<std::size_t>(size);
+        if (padRows) {
+            newStride = (newStride + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+        }
+        std::size_t bytes = newStride * size;
+        if (cells == nullptr || bytes > capacity) {
+            release();
+            cells = GridPool::instance().acquire(bytes, capacity);
+        }
+        gridSize = size;
+        rowStride = newStride;
+    }
+
+    void CharGrid::release() {
+        if (capacity > 0) {
+            GridPool::instance().release(cells, capacity);
+        }
+        cells = nullptr;
+        gridSize = 0;
+        rowStride = 0;
+        capacity = 0;
+    }
+
+    void CharGrid::fill(char ch) {
+        std::fill(cells, cells + rowStride * gridSize, ch);
+    }
+
+    //------------------------------------------------------------------------------
+    // CellMask
+    // One bit per cell. A run along a row covers consecutive bits, so it is
+    // set a word at a time: a masked first word, whole words, a masked last.
+    //------------------------------------------------------------------------------
+    void CellMask::reset(int size) {
+        std::size_t cells = static_cast<std::size_t>(size) * size;
+        gridSize = size;
+        bits.assign((cells + 63) / 64, 0);
+    }
+
+    void CellMask::release() {
+        gridSize = 0;
+        std::vector<std::uint64_t>().swap(bits);
+    }
+
+    void CellMask::setRow(int row, int firstCol, int count) {
+        if (count <= 0) {
+            return;
+        }
+        std::size_t first = index(row, firstCol);
+        std::size_t end = first + count;
+        const std::uint64_t ALL = ~std::uint64_t(0);
+        std::size_t word = first >> 6, lastWord = (end - 1) >> 6;
+        std::uint64_t head = ALL << (first & 63);
+        std::uint64_t tail = ALL >> (63 - ((end - 1) & 63));
+        if (word == lastWord) {
+            bits[word] |= head & tail;
+            return;
+        }
+        bits[word] |= head;
+        while (++word < lastWord) {
+            bits[word] = ALL;
+        }
+        bits[lastWord] |= tail;
+    }
+
+    std::size_t CellMask::count() const {
+        std::size_t total = 0;
+        for (std::uint64_t word : bits) {
+#if defined(__GNUC__)
+            total += static_cast<std::size_t>(__builtin_popcountll(word));
+#else
+            for (; word != 0; word &= word - 1) {
+                ++total;
+            }
+#endif
+        }
+        return total;
     }
 
     //------------------------------------------------------------------------------
     // allocateGrid
-    // Dynamically allocates memory for a 2D char grid of given size.
+    // Sizes the contiguous grid, padding rows to a cache line once the grid is
+    // wide enough for that to matter.
     // Throws runtime_error on failure.
     //------------------------------------------------------------------------------
     void GameMode::allocateGrid(int size) {
         try {
-            gridSize = size;
-            grid = new char* [gridSize];
-            for (int i = 0; i < gridSize; ++i) {
-                grid[i] = new char[gridSize];
-            }
+            grid.reset(size, size >= CACHE_LINE_SIZE);
         }
         catch (const std::bad_alloc& e) {
             std::cerr << "Memory allocation failed: " << e.what() << std::endl;
-            grid = nullptr;
-            gridSize = 0;
+            grid.release();
             throw std::runtime_error("Failed to allocate grid memory");
         }
+        catch (const std::invalid_argument&) {
+            throw std::runtime_error("Invalid grid size " + std::to_string(size));
+        }
     }
 
     //------------------------------------------------------------------------------
-    // populateGrid
-    // Fills the grid with words from the provided list, respecting targetWordCount and targetWordLength.
-    // Remaining cells are filled with random letters, ensuring no unintended words are formed.
+    // gridSizeForLevel
+    // Returns the grid size for a level, or the override when one is set.
     //------------------------------------------------------------------------------
-    void GameMode::populateGrid(const std::string words[], int totalWords, int targetWordCount, int targetWordLength) {
-        // Clear the grid
-        for (int i = 0; i < gridSize; ++i) {
-            for (int j = 0; j < gridSize; ++j) {
-                grid[i][j] = ' ';
-            }
+    int GameMode::gridSizeForLevel(int level) const {
+        if (gridSizeOverride > 0) {
+            return gridSizeOverride;
         }
+        return GRID_SIZES[level - 1];
+    }
 
-        int placedWords = 0;
-        int maxAttempts = 100 * targetWordCount;
-        std::string placedWordsList[MAX_WORDS];
-        int placedWordsCount = 0;
+    //------------------------------------------------------------------------------
+    // generate
+    // Places targetWordCount words of targetWordLength with the given engine,
+    // then fills the remaining cells with random letters that form no further
+    // word of that length and rebuilds the lookup index. Returns what was
+    // placed, how long it took and how dense the placed words are. The grid
+    // depends only on the dictionary, the settings and the state of 'random'.
+    //------------------------------------------------------------------------------
+    PlacementResult GameMode::generate(CharGrid& grid, GridIndex& index, GeneratorEngine engine, const Dictionary& words,
+        int targetWordCount, int targetWordLength, Random& random) {
+        WORDGAME_TIME(PopulateGridTime);
+        auto started = std::chrono::steady_clock::now();
 
-        // Place words randomly in any direction
-        while (placedWords < targetWordCount && maxAttempts > 0) {
-            int wordIndex = rand() % totalWords;
-            const std::string& word = words[wordIndex];
-            if (word.length() != targetWordLength) {
-                continue; // Skip words not matching target length
-            }
+        // Clear the grid
+        grid.fill(' ');
+        int gridSize = grid.size();
+
+        PlacementResult result = (engine == GeneratorEngine::Backtracking)
+            ? BacktrackingGenerator(grid, words, targetWordLength, random).run(targetWordCount)
+            : placeWordsRandomly(grid, words, targetWordCount, targetWordLength, random);
+        WORDGAME_RECORD(PlacementAttempts, result.attempts);
+        WORDGAME_RECORD(PlacementsMade, result.placed);
+        WORDGAME_RECORD(PlacementRejects, result.attempts - result.placed);
+
+        // Fill remaining spaces with letters that spell no word of the level's length
+        long long coveredCells = fillBackground(grid, *words.lineAutomaton(targetWordLength), random);
+
+        index.build(grid);
+        result.density = gridSize > 0 ? static_cast<double>(coveredCells) / (static_cast<double>(gridSize) * gridSize) : 0.0;
+        result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        return result;
+    }
 
-            // Check if word is already placed
-            bool alreadyPlaced = false;
-            for (int i = 0; i < placedWordsCount; ++i) {
-                if (placedWordsList[i] == word) {
-                    alreadyPlaced = true;
-                    break;
-                }
-            }
-            if (alreadyPlaced) {
-                continue;
+    namespace {
+
+        // Directions a row-major fill walks each line in: Right, Down, Down-right, Down-left
+        const int FILL_LINES[4] = { 0, 2, 4, 6 };
+        const int FILL_REDRAWS = 4; // Random redraws before the remaining letters are listed
+
+        //--------------------------------------------------------------------------
+        // spellsWord
+        // True when 'letter' at (row, col) ends a word along the line, given the
+        // automaton state of the cells before it. Cells further along the line
+        // are only filled later, unless a placed word already holds them, so
+        // the walk carries on over placed letters: a word may cross into them
+        // as long as it starts at or before (row, col).
+        //--------------------------------------------------------------------------
+        bool spellsWord(const AhoCorasick& lines, const CharGrid& grid, int row, int col, int direction, int state, char letter) {
+            state = lines.next(state, letter);
+            if (lines.hasOutput(state)) {
+                return true;
             }
-
-            int row = rand() % gridSize;
-            int col = rand() % gridSize;
-            int direction = rand() % NUM_DIRECTIONS;
-
-            // Check if word can be placed
-            bool canPlace = true;
-            for (int k = 0; k < targetWordLength; ++k) {
-                int newRow = row, newCol = col;
-                switch (direction) {
-                case 0: newCol += k; break; // Right
-                case 1: newCol -= k; break; // Left
-                case 2: newRow += k; break; // Down
-                case 3: newRow -= k; break; // Up
-                case 4: newRow += k; newCol += k; break; // Down-right
-                case 5: newRow -= k; newCol += k; break; // Up-right
-                case 6: newRow += k; newCol -= k; break; // Down-left
-                case 7: newRow -= k; newCol -= k; break; // Up-left
-                }
-
-                if (newRow < 0 || newRow >= gridSize || newCol < 0 || newCol >= gridSize) {
-                    canPlace = false;
+            int dRow = DIRECTION_ROW[direction], dCol = DIRECTION_COL[direction];
+            int size = grid.size();
+            for (int k = 1; k < lines.maxWordLength(); ++k) {
+                int r = row + k * dRow, c = col + k * dCol;
+                if (r >= size || c < 0 || c >= size || grid.at(r, c) == ' ') {
                     break;
                 }
-                if (grid[newRow][newCol] != ' ' && grid[newRow][newCol] != word[k]) {
-                    canPlace = false;
-                    break;
+                state = lines.next(state, grid.at(r, c));
+                if (lines.hasOutput(state)) {
+                    return true;
                 }
             }
+            return false;
+        }
+
+    } // namespace
+
+    //------------------------------------------------------------------------------
+    // fillBackground
+    // Fills the empty cells in row-major order. Every row, column, diagonal and
+    // anti-diagonal keeps the automaton state of its cells so far, so a letter
+    // is checked against the four lines through its cell at constant cost and
+    // the fill stays linear in the grid area. The automaton holds each word
+    // and its reversal, which covers all eight directions. A drawn letter that
+    // would complete a word is replaced by one drawn from the letters that do
+    // not; when every letter would (placed words can force that), the first
+    // draw is kept.
+    //------------------------------------------------------------------------------
+    long long GameMode::fillBackground(CharGrid& grid, const AhoCorasick& lines, Random& random) {
+        int size = grid.size();
+        long long coveredCells = 0;
+        std::uint64_t redraws = 0;
+        std::vector<int> columns(static_cast<std::size_t>(size), 0);
+        std::vector<int> diagonals(static_cast<std::size_t>(2 * size), 0); // By col - row + size - 1
+        std::vector<int> antiDiagonals(static_cast<std::size_t>(2 * size), 0); // By row + col
+        std::vector<char> letters(static_cast<std::size_t>(size));
+        const bool filtering = lines.stateCount() > 1; // No words of the length means nothing to avoid
+
+        for (int i = 0; i < size; ++i) {
+            char* row = grid.rowData(i);
+            random.fillLetters(letters.data(), letters.size());
+            int across = 0;
+            for (int j = 0; j < size; ++j) {
+                int* states[4] = { &across, &columns[j], &diagonals[j - i + size - 1], &antiDiagonals[i + j] };
+                auto spells = [&](char letter) {
+                    for (int line = 0; line < 4; ++line) {
+                        if (spellsWord(lines, grid, i, j, FILL_LINES[line], *states[line], letter)) {
+                            return true;
+                        }
+                    }
+                    return false;
+                };
 
-            // Place the word
-            if (canPlace) {
-                for (int k = 0; k < targetWordLength; ++k) {
-                    int newRow = row, newCol = col;
-                    switch (direction) {
-                    case 0: newCol += k; break;
-                    case 1: newCol -= k; break;
-                    case 2: newRow += k; break;
-                    case 3: newRow -= k; break;
-                    case 4: newRow += k; newCol += k; break;
-                    case 5: newRow -= k; newCol += k; break;
-                    case 6: newRow += k; newCol -= k; break;
-                    case 7: newRow -= k; newCol -= k; break;
+                if (row[j] != ' ') {
+                    ++coveredCells;
+                }
+                else if (filtering && spells(letters[j])) {
+                    // Redraw a few times, then pick among the letters left; both are uniform over them
+                    ++redraws;
+                    char letter = letters[j];
+                    for (int tries = 0; tries < FILL_REDRAWS && spells(letter); ++tries) {
+                        letter = static_cast<char>('a' + random.below(ALPHABET_SIZE));
+                    }
+                    if (spells(letter)) {
+                        char allowed[ALPHABET_SIZE];
+                        int allowedCount = 0;
+                        for (char candidate = 'a'; candidate <= 'z'; ++candidate) {
+                            if (!spells(candidate)) {
+                                allowed[allowedCount++] = candidate;
+                            }
+                        }
+                        letter = allowedCount > 0 ? allowed[random.below(allowedCount)] : letters[j];
                     }
-                    grid[newRow][newCol] = word[k];
+                    row[j] = letter;
+                }
+                else {
+                    row[j] = letters[j];
                 }
-                placedWordsList[placedWordsCount++] = word;
-                ++placedWords;
-            }
-            --maxAttempts;
-        }
 
-        // Fill remaining spaces with random letters
-        for (int i = 0; i < gridSize; ++i) {
-            for (int j = 0; j < gridSize; ++j) {
-                if (grid[i][j] == ' ') {
-                    grid[i][j] = 'a' + (rand() % 26); // Random lowercase letter
+                for (int line = 0; line < 4; ++line) {
+                    *states[line] = lines.next(*states[line], row[j]);
                 }
             }
         }
+
+        WORDGAME_RECORD(FillRedraws, redraws);
+        return coveredCells;
     }
 
     //------------------------------------------------------------------------------
-    // printGrid
-    // Prints the current state of the grid to the console with borders.
+    // populateGrid
+    // Fills the allocated grid with the selected engine.
     //------------------------------------------------------------------------------
-    void GameMode::printGrid() {
-        std::cout << "   ";
-        for (int col = 0; col < gridSize; ++col) {
-            std::cout << "  " << col << "  ";
-        }
-        std::cout << std::endl;
+    PlacementResult GameMode::populateGrid(const Dictionary& words, int targetWordCount, int targetWordLength, Random& random) {
+        placement = generate(grid, index, generator, words, targetWordCount, targetWordLength, random);
+        return placement;
+    }
 
-        for (int i = 0; i < gridSize; ++i) {
-            std::cout << " ";
-            for (int k = 0; k < gridSize; ++k) {
-                std::cout << " - - ";
-            }
-            std::cout << std::endl;
+    //------------------------------------------------------------------------------
+    // makePuzzle
+    // Builds a level's grid from this mode's settings into a new Puzzle. Only
+    // the settings are read, so this can run on another thread while the
+    // mode's current grid is in play.
+    //------------------------------------------------------------------------------
+    Puzzle GameMode::makePuzzle(const Dictionary& words, int level, Random& random) const {
+        Puzzle puzzle;
+        int size = gridSizeForLevel(level);
+        puzzle.level = level;
+        puzzle.grid.reset(size, size >= CACHE_LINE_SIZE);
+        puzzle.placement = generate(puzzle.grid, puzzle.index, generator, words, wordCountForLevel(level), getWordLength(level), random);
+        return puzzle;
+    }
+
+    void GameMode::adopt(Puzzle puzzle) {
+        grid = std::move(puzzle.grid);
+        index = std::move(puzzle.index);
+        placement = puzzle.placement;
+    }
+
+    //------------------------------------------------------------------------------
+    // placeWordsRandomly
+    // Places words of targetWordLength drawn without replacement from the
+    // dictionary's bucket for that length. Each word gets a few placement
+    // tries at starts where it fits inside the grid. Every try counts against
+    // a budget of 100 per requested word, so the running time is bounded by
+    // the request, not by the dictionary. The placement kernels for the length
+    // are picked once; a try only indexes them by direction.
+    //------------------------------------------------------------------------------
+    PlacementResult GameMode::placeWordsRandomly(CharGrid& grid, const Dictionary& words, int targetWordCount, int targetWordLength, Random& random) {
+        int gridSize = grid.size();
+        PlacementResult result = { 0, targetWordCount, 0, 0, 0.0, 0.0 };
+        const int maxAttempts = 100 * targetWordCount;
+        const int triesPerWord = 10;
+        WordBucket candidates = words.bucket(targetWordLength);
+        int remaining = (targetWordLength > 0 && targetWordLength <= gridSize) ? candidates.count : 0;
+        std::unordered_map<int, int> swapped; // Sparse Fisher-Yates: slot -> bucket position moved into it
+        const std::array<PlaceKernel, NUM_DIRECTIONS>& place = placeKernels(targetWordLength);
 
-            std::cout << i << " ";
-            for (int j = 0; j < gridSize; ++j) {
-                std::cout << " | " << grid[i][j] << " ";
+        // Place words randomly in any direction
+        while (result.placed < targetWordCount && result.attempts < maxAttempts && remaining > 0) {
+            int slot = random.below(remaining);
+            auto at = [&](int position) {
+                auto found = swapped.find(position);
+                return found == swapped.end() ? position : found->second;
+            };
+            int position = at(slot);
+            swapped[slot] = at(remaining - 1);
+            --remaining;
+            std::string_view word = words.word(candidates.id(position));
+
+            for (int tries = 0; tries < triesPerWord && result.attempts < maxAttempts; ++tries) {
+                ++result.attempts;
+                int direction = random.below(NUM_DIRECTIONS);
+                int dRow = DIRECTION_ROW[direction], dCol = DIRECTION_COL[direction];
+
+                // Pick a start from which the whole word stays inside the grid
+                int span = gridSize - targetWordLength + 1;
+                int row = (dRow == 0) ? random.below(gridSize) : random.below(span) + (dRow < 0 ? targetWordLength - 1 : 0);
+                int col = (dCol == 0) ? random.below(gridSize) : random.below(span) + (dCol < 0 ? targetWordLength - 1 : 0);
+
+                // Place the word if every cell is free or already holds its letter
+                if (place[direction](word, grid, row, col)) {
+                    ++result.placed;
+                    break;
+                }
             }
-            std::cout << "|" << std::endl;
         }
 
-        std::cout << "  ";
-        for (int k = 0; k < gridSize; ++k) {
-            std::cout << " - - ";
-        }
-        std::cout << std::endl;
+        return result;
+    }
+
+    //------------------------------------------------------------------------------
+    // printGrid
+    // Prints a grid with borders, built as one block of text and written at
+    // once. Given a found mask, found cells are printed in capitals.
+    //------------------------------------------------------------------------------
+    void GameMode::printGrid(const CharGrid& grid, std::ostream& out) {
+        std::string text;
+        GridRenderer::appendGrid(text, grid);
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        out.flush();
+        WORDGAME_RECORD(RenderBytes, text.size());
+    }
+
+    void GameMode::printGrid(const CharGrid& grid, const CellMask& found, std::ostream& out) {
+        std::string text;
+        GridRenderer::appendGrid(text, grid, &found);
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        out.flush();
+        WORDGAME_RECORD(RenderBytes, text.size());
     }
 
     //------------------------------------------------------------------------------
     // clearGrid
-    // Frees dynamically allocated grid memory.
+    // Hands the grid buffer back to the pool.
     //------------------------------------------------------------------------------
     void GameMode::clearGrid() {
-        if (grid != nullptr) {
-            for (int i = 0; i < gridSize; ++i) {
-                delete[] grid[i];
-            }
-            delete[] grid;
-            grid = nullptr;
-            gridSize = 0;
-        }
+        grid.release();
+        index.clear();
     }
 
     //------------------------------------------------------------------------------
@@ -181,11 +470,9 @@ namespace WordGame {
     // Allocates and populates the grid based on the selected level.
     //------------------------------------------------------------------------------
     void EasyMode::Grid(const std::string& level, const std::string& filename) {
-        std::string easyWords[MAX_WORDS];
-        int totalEasyWords = 0;
-        WordValidator validator;
+        std::shared_ptr<const Dictionary> easyWords;
         try {
-            validator.loadWords(filename, easyWords, totalEasyWords);
+            easyWords = DictionaryRegistry::instance().get(filename);
         }
         catch (const std::exception& e) {
             std::cout << "Error: " << e.what() << std::endl;
@@ -193,8 +480,8 @@ namespace WordGame {
         }
 
         int levelNum = std::stoi(level);
-        allocateGrid(GRID_SIZES[levelNum - 1]);
-        populateGrid(easyWords, totalEasyWords, getWordCount(levelNum), getWordLength(levelNum));
+        allocateGrid(gridSizeForLevel(levelNum));
+        populateGrid(*easyWords, wordCountForLevel(levelNum), getWordLength(levelNum), random);
     }
 
     
@@ -204,11 +491,9 @@ namespace WordGame {
     // Allocates and populates the grid based on the selected level.
     //------------------------------------------------------------------------------
     void HardMode::Grid(const std::string& level, const std::string& filename) {
-        std::string hardWords[MAX_WORDS];
-        int totalHardWords = 0;
-        WordValidator validator;
+        std::shared_ptr<const Dictionary> hardWords;
         try {
-            validator.loadWords(filename, hardWords, totalHardWords);
+            hardWords = DictionaryRegistry::instance().get(filename);
         }
         catch (const std::exception& e) {
             std::cout << "Error: " << e.what() << std::endl;
@@ -216,439 +501,154 @@ namespace WordGame {
         }
 
         int levelNum = std::stoi(level);
-        allocateGrid(GRID_SIZES[levelNum - 1]);
-        populateGrid(hardWords, totalHardWords, getWordCount(levelNum), getWordLength(levelNum));
+        allocateGrid(gridSizeForLevel(levelNum));
+        populateGrid(*hardWords, wordCountForLevel(levelNum), getWordLength(levelNum), random);
     }
 
     //------------------------------------------------------------------------------
     // getWordLength and getWordCount for EasyMode
     //------------------------------------------------------------------------------
     int EasyMode::getWordLength(int level) const {
-        switch (level) {
-        case 1: return 2;
-        case 2: return 3;
-        case 3: return 4;
-        default: return 3; // Fallback
-        }
+        return (level >= 1 && level <= NUM_LEVELS) ? EASY_WORD_LENGTHS[level - 1] : EASY_WORD_LENGTHS[1]; // Level 2 as the fallback
     }
 
     int EasyMode::getWordCount(int level) const {
-        switch (level) {
-        case 1: return 3;
-        case 2: return 5;
-        case 3: return 7;
-        default: return 5; // Fallback
-        }
+        return (level >= 1 && level <= NUM_LEVELS) ? LEVEL_WORD_COUNTS[level - 1] : LEVEL_WORD_COUNTS[1];
     }
 
     //------------------------------------------------------------------------------
     // getWordLength and getWordCount for HardMode
     //------------------------------------------------------------------------------
     int HardMode::getWordLength(int level) const {
-        switch (level) {
-        case 1: return 5;
-        case 2: return 6;
-        case 3: return 7;
-        default: return 5; // Fallback
-        }
+        return (level >= 1 && level <= NUM_LEVELS) ? HARD_WORD_LENGTHS[level - 1] : HARD_WORD_LENGTHS[0]; // Level 1 as the fallback
     }
 
     int HardMode::getWordCount(int level) const {
-        switch (level) {
-        case 1: return 3;
-        case 2: return 5;
-        case 3: return 7;
-        default: return 5; // Fallback
-        }
+        return (level >= 1 && level <= NUM_LEVELS) ? LEVEL_WORD_COUNTS[level - 1] : LEVEL_WORD_COUNTS[1];
     }
 
     //------------------------------------------------------------------------------
     // isValidWord
     // Validates if the provided word exists in the dictionary.
     //------------------------------------------------------------------------------
-    bool WordValidator::isValidWord(const std::string& word, const std::string dictionary[], int dictionarySize) {
-        for (int i = 0; i < dictionarySize; ++i) {
-            if (dictionary[i] == word) {
-                return true;
-            }
-        }
-        return false;
+    bool WordValidator::isValidWord(const std::string& word, const Dictionary& dictionary) {
+        return dictionary.contains(word);
     }
 
     //------------------------------------------------------------------------------
     // loadWords
-    // Loads words from a file into an array.
+    // Loads every word in a file into the dictionary without copying them.
     //------------------------------------------------------------------------------
-    void WordValidator::loadWords(const std::string& filename, std::string words[], int& wordSize) {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            throw std::runtime_error("Could not open file " + filename);
-        }
-        std::string word;
-        wordSize = 0;
-        while (file >> word && wordSize < MAX_WORDS) {
-            words[wordSize++] = word;
-        }
-        file.close();
+    void WordValidator::loadWords(const std::string& filename, Dictionary& words) {
+        words.load(filename);
     }
 
-    //------------------------------------------------------------------------------
-    // checkWordInGrid
-    // Checks if a word exists in the grid in any direction, removing it if found.
-    //------------------------------------------------------------------------------
-    bool WordValidator::checkWordInGrid(std::string word, char** grid, int gridSize) {
-        int wordLen = static_cast<int>(word.length());
-        for (int i = 0; i < gridSize; ++i) {
-            for (int j = 0; j < gridSize; ++j) {
-                for (int d = 0; d < NUM_DIRECTIONS; ++d) {
-                    if ((d == 0 && j + wordLen > gridSize) || // Right
-                        (d == 1 && j - wordLen + 1 < 0) || // Left
-                        (d == 2 && i + wordLen > gridSize) || // Down
-                        (d == 3 && i - wordLen + 1 < 0) || // Up
-                        (d == 4 && (i + wordLen > gridSize || j + wordLen > gridSize)) || // Down-right
-                        (d == 5 && (i - wordLen + 1 < 0 || j + wordLen > gridSize)) || // Up-right
-                        (d == 6 && (i + wordLen > gridSize || j - wordLen + 1 < 0)) || // Down-left
-                        (d == 7 && (i - wordLen + 1 < 0 || j - wordLen + 1 < 0))) { // Up-left
-                        continue;
-                    }
-
-                    bool match = true;
-                    int i2 = i, j2 = j;
-                    for (int k = 0; k < wordLen; ++k) {
-                        if (std::tolower(word[k]) != std::tolower(grid[i2][j2])) {
-                            match = false;
-                            break;
-                        }
-                        switch (d) {
-                        case 0: j2++; break; // Right
-                        case 1: j2--; break; // Left
-                        case 2: i2++; break; // Down
-                        case 3: i2--; break; // Up
-                        case 4: i2++; j2++; break; // Down-right
-                        case 5: i2--; j2++; break; // Up-right
-                        case 6: i2++; j2--; break; // Down-left
-                        case 7: i2--; j2--; break; // Up-left
-                        }
-                    }
-
-                    if (match) {
-                        i2 = i; j2 = j;
-                        for (int k = 0; k < wordLen; ++k) {
-                            grid[i2][j2] = '*'; // Mark matched word
-                            switch (d) {
-                            case 0: j2++; break;
-                            case 1: j2--; break;
-                            case 2: i2++; break;
-                            case 3: i2--; break;
-                            case 4: i2++; j2++; break;
-                            case 5: i2--; j2++; break;
-                            case 6: i2++; j2--; break;
-                            case 7: i2--; j2--; break;
-                            }
-                        }
-                        std::cout << "++++++++++++ Matched ++++++++++++++\n";
-                        return true;
+    namespace {
+
+        const int SEARCH_BAND_CELLS = 1 << 14; // Start cells per band of a parallel scan
+
+        //--------------------------------------------------------------------------
+        // scanBands
+        // scanGrid on the worker pool. The start rows are cut into bands, many
+        // more than threads, so work stealing evens them out. A band reads the
+        // length - 1 rows past its end through the shared grid, which is the
+        // overlap that lets words cross band borders. The serial scan returns
+        // the first start in row-major order, which is the first match of the
+        // lowest band that has one: a band is skipped once a lower band has
+        // matched, and the lowest matching band wins.
+        //--------------------------------------------------------------------------
+        bool scanBands(const char* word, int length, const CharGrid& grid, int threads, WordMatch& match, std::uint64_t& probes) {
+            int size = grid.size();
+            int bandRows = std::max(1, SEARCH_BAND_CELLS / size);
+            int bands = (size + bandRows - 1) / bandRows;
+            std::vector<WordMatch> matches(static_cast<std::size_t>(bands));
+            std::atomic<int> firstBand(bands); // Lowest band with a match so far
+            std::atomic<std::uint64_t> totalProbes(0);
+
+            parallelFor(bands, threads, [&](int band) {
+                if (firstBand.load(std::memory_order_relaxed) < band) {
+                    return; // A lower band already has the answer
+                }
+                std::uint64_t bandProbes = 0;
+                CellRange starts = { band * bandRows, std::min(size, (band + 1) * bandRows), 0, size };
+                bool found = scanGrid(word, length, grid, starts, matches[band], bandProbes);
+                totalProbes.fetch_add(bandProbes, std::memory_order_relaxed);
+                if (found) {
+                    int lowest = firstBand.load(std::memory_order_relaxed);
+                    while (band < lowest && !firstBand.compare_exchange_weak(lowest, band, std::memory_order_relaxed)) {
                     }
                 }
+            });
+
+            probes += totalProbes.load();
+            int band = firstBand.load();
+            if (band == bands) {
+                return false;
             }
+            match = matches[band];
+            return true;
         }
-        return false;
-    }
-
-    //------------------------------------------------------------------------------
-    // displayInstructions
-    // Displays game rules and instructions.
-    //------------------------------------------------------------------------------
-    void Game::displayInstructions() {
-        std::cout << "\033[2J\033[1;1H"; // Clear screen (portable)
-        std::cout << "========================================================================\n";
-        std::cout << "||                           INSTRUCTIONS                             ||\n";
-        std::cout << "========================================================================\n";
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-        std::cout << "| You have two modes: 'Easy' and 'Hard'. Each mode has 3 levels.       |\n";
-        std::cout << "| In level 1, the grid is 10x10, and you must guess 3 words.           |\n";
-        std::cout << "| In level 2, the grid is 15x15, and you must guess 5 words.           |\n";
-        std::cout << "| In level 3, the grid is 20x20, and you must guess 7 words.           |\n";
-        std::cout << "| In Easy Mode:                                                        |\n";
-        std::cout << "|   - Level 1: Max word length is 2 characters.                        |\n";
-        std::cout << "|   - Level 2: Max word length is 3 characters.                        |\n";
-        std::cout << "|   - Level 3: Max word length is 4 characters.                        |\n";
-        std::cout << "| In Hard Mode:                                                        |\n";
-        std::cout << "|   - Level 1: Max word length is 5 characters.                        |\n";
-        std::cout << "|   - Level 2: Max word length is 6 characters.                        |\n";
-        std::cout << "|   - Level 3: Max word length is 7 characters.                        |\n";
-        std::cout << "| You have " << MAX_CHANCES << " chances to guess the correct word.         |\n";
-        std::cout << "========================================================================\n";
-        std::cout << "Press Enter to return to menu...";
-        std::cin.get();
-    }
-
-    //------------------------------------------------------------------------------
-    // AboutUs
-    // Displays developer information.
-    //------------------------------------------------------------------------------
-    void Game::AboutUs() {
-        std::cout << "\033[2J\033[1;1H";
-        std::cout << "========================================================================\n";
-        std::cout << "||                            ABOUT US                                ||\n";
-        std::cout << "========================================================================\n";
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-        std::cout << "|| -> This Game is made by Muhammad Abdullah and Hafiz Faheem.        ||\n";
-        std::cout << "|| -> We are students at Fast NUCES CFD campus, studying CS.          ||\n";
-        std::cout << "========================================================================\n";
-        std::cout << "Press Enter to return to menu...";
-        std::cin.get();
-    }
-
-    //------------------------------------------------------------------------------
-    // displayMenu
-    // Displays the main menu and handles user input.
-    //------------------------------------------------------------------------------
-    void Game::displayMenu() {
-        std::string choice;
-        do {
-            std::cout << "\033[2J\033[1;1H";
-            std::cout << "========================================================================\n";
-            std::cout << "||                         Word Guessing Game                         ||\n";
-            std::cout << "========================================================================\n";
-            std::cout << "||                             MAIN MENU                              ||\n";
-            std::cout << "========================================================================\n";
-            std::cout << "|| -> Press (a) to Start Game                                         ||\n";
-            std::cout << "|| -> Press (b) to Display Rules and Instructions                     ||\n";
-            std::cout << "|| -> Press (c) for About Us                                          ||\n";
-            std::cout << "|| -> Press (d) to Display Highest Scores                             ||\n";
-            std::cout << "|| -> Press (e) to Exit                                               ||\n";
-            std::cout << "========================================================================\n";
-            std::cout << "Enter your Choice: ";
-            std::getline(std::cin, choice);
-
-            if (choice.empty() || choice.length() > 1 || std::tolower(choice[0]) < 'a' || std::tolower(choice[0]) > 'e') {
-                std::cout << "Invalid input! Please enter a single character (a-e).\n";
-                std::this_thread::sleep_for(std::chrono::seconds(1));
-                continue;
-            }
 
-            choice = std::tolower(choice[0]);
-            if (choice == "a") {
-                startGame();
-            }
-            else if (choice == "b") {
-                displayInstructions();
-            }
-            else if (choice == "c") {
-                AboutUs();
-            }
-            else if (choice == "d") {
-                HighestScore();
-            }
-            else if (choice == "e") {
-                break;
-            }
-        } while (true);
+    } // namespace
+
+    //------------------------------------------------------------------------------
+    // checkWordInGrid
+    // Checks if a word exists in the grid in any direction, marking its cells in
+    // 'found' if it does. The grid is only read.
+    // Scans every cell; kept as the reference for the indexed lookup below. The
+    // scan runs the kernel specialized for the word's length, which tries the
+    // eight directions per cell without a switch. Large grids are scanned in
+    // bands on several threads, with the same result.
+    //------------------------------------------------------------------------------
+    bool WordValidator::checkWordInGrid(std::string word, const CharGrid& grid, CellMask& found) {
+        int wordLen = static_cast<int>(word.length());
+        if (wordLen == 0) {
+            return false;
+        }
+        std::string lowered(word);
+        for (char& ch : lowered) {
+            ch = lowercase(ch);
+        }
+        WordMatch match;
+        std::uint64_t directionsProbed = 0;
+        int threads = searchThreads > 0 ? searchThreads : hardwareThreads();
+        bool parallel = threads > 1 && static_cast<long long>(grid.size()) * grid.size() >= PARALLEL_SEARCH_MIN_CELLS;
+        bool matched = parallel ? scanBands(lowered.data(), wordLen, grid, threads, match, directionsProbed)
+            : scanGrid(lowered.data(), wordLen, grid, match, directionsProbed);
+        WORDGAME_RECORD(SearchCellsProbed, directionsProbed * static_cast<std::uint64_t>(wordLen));
+        WORDGAME_RECORD(SearchDirectionsProbed, directionsProbed);
+        return matched && markWord(word, found, match);
     }
 
     //------------------------------------------------------------------------------
-    // HighestScore
-    // Displays the top five highest scores.
+    // checkWordInGrid (indexed)
+    // Same result as the full scan, but only probes the cells where the word's
+    // first two letters start, so the cost follows the number of candidates.
     //------------------------------------------------------------------------------
-    void Game::HighestScore() {
-        std::cout << "\033[2J\033[1;1H";
-        std::cout << "========================================================================\n";
-        std::cout << "||                           HIGHEST SCORE                            ||\n";
-        std::cout << "========================================================================\n";
-
-        ScoreTracker scoreTracker;
-        scoreTracker.loadScores("scores.txt");
-
-        for (int i = 0; i < 5; ++i) {
-            std::cout << "Score " << (i + 1) << ": " << scoreTracker.getTopScore(i) << std::endl;
-        }
-        std::cout << "Press Enter to return to menu...";
-        std::cin.get();
+    bool WordValidator::checkWordInGrid(std::string word, const CharGrid& grid, const GridIndex& index, CellMask& found) {
+        WordMatch match;
+        return index.find(word, grid, match) && markWord(word, found, match);
     }
 
     //------------------------------------------------------------------------------
-    // startGame
-    // Manages game mode and level selection, grid setup, and guessing logic.
+    // markWord
+    // Sets the cells of a matched word in the found mask. A word along a row
+    // is one run of bits; the other directions set a bit per letter. Returns
+    // false, marking nothing, for an empty word.
     //------------------------------------------------------------------------------
-    void Game::startGame() {
-        int modeSel;
-        std::cout << "\033[2J\033[1;1H";
-        std::cout << "-------------------------------\n";
-        std::cout << "|       Select Game Mode:     |\n";
-        std::cout << "-------------------------------\n";
-
-        while (true) {
-            std::cout << "| -> Press (1) for Easy Mode  |\n";
-            std::cout << "| -> Press (2) for Hard Mode  |\n";
-            std::cout << "-------------------------------\n";
-            std::cout << "Enter your choice: ";
-            std::string input;
-            std::getline(std::cin, input);
-
-            if (input == "1" || input == "2") {
-                modeSel = std::stoi(input);
-                break;
-            }
-            std::cout << "Invalid choice! Please enter 1 or 2.\n";
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-        }
-
-        GameMode* mode = nullptr;
-        try {
-            mode = (modeSel == 1) ? static_cast<GameMode*>(new EasyMode()) : static_cast<GameMode*>(new HardMode());
-        }
-        catch (const std::bad_alloc& e) {
-            std::cout << "Memory allocation failed: " << e.what() << std::endl;
-            return;
-        }
-
-        int levelSel;
-        while (true) {
-            std::cout << "-------------------------------\n";
-            std::cout << "|       Select Level:         |\n";
-            std::cout << "-------------------------------\n";
-            std::cout << "| -> Press (1) for Level 1    |\n";
-            std::cout << "| -> Press (2) for Level 2    |\n";
-            std::cout << "| -> Press (3) for Level 3    |\n";
-            std::cout << "-------------------------------\n";
-            std::cout << "Enter your choice: ";
-            std::string input;
-            std::getline(std::cin, input);
-
-            if (input == "1" || input == "2" || input == "3") {
-                levelSel = std::stoi(input);
-                break;
-            }
-            std::cout << "Invalid choice! Please enter 1, 2, or 3.\n";
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-        }
-
-        int totalChances = MAX_CHANCES;
-        const int maxGuesses = 100;
-        std::string guessedWords[maxGuesses];
-        int guessedCount = 0;
-
-        std::string dictionary[MAX_WORDS];
-        int dictionarySize = 0;
-        WordValidator validator;
-        try {
-            std::string filename = (modeSel == 1) ? "easy_words.txt" : "hard_words.txt";
-            validator.loadWords(filename, dictionary, dictionarySize);
+    bool WordValidator::markWord(const std::string& word, CellMask& found, const WordMatch& match) {
+        int wordLen = static_cast<int>(word.length());
+        if (wordLen == 0) {
+            return false;
         }
-        catch (const std::exception& e) {
-            std::cout << "Error: " << e.what() << std::endl;
-            delete mode;
-            return;
+        if (DIRECTION_ROW[match.direction] == 0) {
+            found.setRow(match.row, DIRECTION_COL[match.direction] > 0 ? match.col : match.col - wordLen + 1, wordLen);
+            return true;
         }
-
-        ScoreTracker scoreTracker;
-
-        for (int level = levelSel; level <= 3; ++level) {
-            std::string filename = (modeSel == 1) ? "easy_words.txt" : "hard_words.txt";
-            mode->Grid(std::to_string(level), filename);
-            if (!mode->getGrid()) {
-                std::cout << "Failed to initialize grid for level " << level << std::endl;
-                break;
-            }
-
-            std::cout << "\033[2J\033[1;1H";
-            std::cout << "============================\n";
-            std::cout << "|          GRID            |\n";
-            std::cout << "============================\n";
-            mode->printGrid();
-
-            std::string guess;
-            int wordCount = mode->getWordCount(level);
-            int successfulGuesses = 0;
-
-            std::cout << "You need to guess " << wordCount << " words to complete level " << level << ".\n";
-            std::cout << "Chances remaining: " << totalChances << "\n\n";
-
-            while (totalChances > 0 && successfulGuesses < wordCount) {
-                std::cout << "Enter a word to guess: ";
-                std::getline(std::cin, guess);
-
-                int wordLength = mode->getWordLength(level);
-                if (guess.length() != wordLength) {
-                    std::cout << "Word must be exactly " << wordLength << " characters long.\n";
-                    --totalChances;
-                    std::cout << "Chances remaining: " << totalChances << "\n\n";
-                    continue;
-                }
-
-                bool alreadyGuessed = false;
-                for (int i = 0; i < guessedCount; ++i) {
-                    if (guessedWords[i] == guess) {
-                        alreadyGuessed = true;
-                        break;
-                    }
-                }
-                if (alreadyGuessed) {
-                    std::cout << "You already guessed this word.\n";
-                    --totalChances;
-                    std::cout << "Chances remaining: " << totalChances << "\n\n";
-                    continue;
-                }
-
-                if (validator.checkWordInGrid(guess, mode->getGrid(), mode->getGridSize())) {
-                    if (!validator.isValidWord(guess, dictionary, dictionarySize)) {
-                        std::cout << "Word is in grid but not in dictionary.\n";
-                        --totalChances;
-                        std::cout << "Chances remaining: " << totalChances << "\n\n";
-                        continue;
-                    }
-
-                    std::cout << "Congratulations! You found: " << guess << "\n";
-                    guessedWords[guessedCount++] = guess;
-                    ++successfulGuesses;
-                    scoreTracker.updateScore(true);
-                    mode->printGrid();
-                }
-                else {
-                    std::cout << "Word not found in grid.\n";
-                    --totalChances;
-                    scoreTracker.updateScore(false);
-                }
-
-                std::cout << "Guessed words: " << guessedCount << " / " << wordCount << "\n";
-                std::cout << "Chances remaining: " << totalChances << "\n\n";
-            }
-
-            if (successfulGuesses < wordCount) {
-                std::cout << "Game Over! Final score: " << scoreTracker.getScore() << "\n";
-                std::cout << "Words found: ";
-                for (int i = 0; i < guessedCount; ++i) {
-                    std::cout << guessedWords[i] << " ";
-                }
-                std::cout << "\n";
-                std::cout << "Retry level? (y/n): ";
-                std::string retry;
-                std::getline(std::cin, retry);
-                if (retry == "y" || retry == "Y") {
-                    --level; // Replay current level
-                    totalChances = MAX_CHANCES;
-                    guessedCount = 0;
-                    scoreTracker = ScoreTracker(); // Reset score
-                    continue;
-                }
-                break;
-            }
-
-            std::cout << "Congratulations! You've completed level " << level << "!\n";
-            if (level < 3) {
-                std::cout << "Continue to next level? (y/n): ";
-                std::string choice;
-                std::getline(std::cin, choice);
-                if (choice != "y" && choice != "Y") {
-                    break;
-                }
-            }
+        for (int k = 0; k < wordLen; ++k) {
+            found.set(match.row + k * DIRECTION_ROW[match.direction], match.col + k * DIRECTION_COL[match.direction]);
         }
-
-        scoreTracker.compareAndUpdateScores("scores.txt");
-        mode->clearGrid();
-        delete mode;
+        return true;
     }
 
     //------------------------------------------------------------------------------
@@ -660,59 +660,8 @@ namespace WordGame {
         }
     }
 
-    void ScoreTracker::loadScores(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            std::ofstream initFile(filename);
-            for (int i = 0; i < 5; ++i) {
-                initFile << "0\n";
-                topScores[i] = 0;
-            }
-            initFile.close();
-            return;
-        }
-        for (int i = 0; i < 5; ++i) {
-            if (!(file >> topScores[i])) {
-                topScores[i] = 0;
-            }
-        }
-        file.close();
-    }
-
-    void ScoreTracker::saveScores(const std::string& filename) {
-        std::ofstream file(filename);
-        if (!file.is_open()) {
-            throw std::runtime_error("Could not open file " + filename + " for writing");
-        }
-        for (int i = 0; i < 5; ++i) {
-            file << topScores[i] << "\n";
-        }
-        file.close();
-    }
-
     int ScoreTracker::getScore() const {
         return score;
     }
 
-    int ScoreTracker::getTopScore(int index) const {
-        if (index >= 0 && index < 5) {
-            return topScores[index];
-        }
-        return 0;
-    }
-
-    void ScoreTracker::compareAndUpdateScores(const std::string& filename) {
-        loadScores(filename);
-        for (int i = 0; i < 5; ++i) {
-            if (score > topScores[i]) {
-                for (int j = 4; j > i; --j) {
-                    topScores[j] = topScores[j - 1];
-                }
-                topScores[i] = score;
-                break;
-            }
-        }
-        saveScores(filename);
-    }
-
 } // namespace WordGame
\ No newline at end of file
@@ -0,0 +1,185 @@
+#pragma once
+#include "header.h"
+#include <array>
+#include <utility>
+
+//-------------------------------------------------------
+// Search and placement kernels specialized at compile
+// time on the direction and on the word length. The
+// lengths of both modes' levels (2 to 7) get a fully
+// unrolled kernel whose compare loop has no branches;
+// any other length uses the Length = 0 version, which
+// reads the length at run time. Callers pick a kernel
+// once per call, never per cell.
+//-------------------------------------------------------
+
+namespace WordGame {
+
+    // tolower() for the C locale, as a table
+    constexpr std::array<char, 256> LOWERCASE = [] {
+        std::array<char, 256> table = {};
+        for (int ch = 0; ch < 256; ++ch) {
+            table[ch] = static_cast<char>(ch >= 'A' && ch <= 'Z' ? ch - 'A' + 'a' : ch);
+        }
+        return table;
+    }();
+
+    inline char lowercase(char ch) {
+        return LOWERCASE[static_cast<unsigned char>(ch)];
+    }
+
+    //-------------------------------------------------------
+    // fitsFrom is true when a word of 'length' letters that
+    // starts at (row, col) stays inside a grid of 'size'.
+    // Only the bounds the direction can cross are tested.
+    //-------------------------------------------------------
+    template <int Direction>
+    inline bool fitsFrom(int row, int col, int size, int length) {
+        constexpr int dRow = DIRECTION_ROW[Direction], dCol = DIRECTION_COL[Direction];
+        return (dRow >= 0 || row >= length - 1) && (dRow <= 0 || row + length <= size) &&
+            (dCol >= 0 || col >= length - 1) && (dCol <= 0 || col + length <= size);
+    }
+
+    // Byte offset between consecutive letters of a word running in Direction
+    template <int Direction>
+    inline std::ptrdiff_t directionStep(const CharGrid& grid) {
+        return DIRECTION_ROW[Direction] * static_cast<std::ptrdiff_t>(grid.stride()) + DIRECTION_COL[Direction];
+    }
+
+    //-------------------------------------------------------
+    // matchesAt compares a lowercase word with the cells
+    // from (row, col) in Direction, ignoring the case of
+    // the grid. The word must fit.
+    //-------------------------------------------------------
+    template <int Direction, int Length>
+    inline bool matchesAt(const char* word, int length, const CharGrid& grid, int row, int col) {
+        const char* cell = grid.rowData(row) + col;
+        const std::ptrdiff_t step = directionStep<Direction>(grid);
+        if constexpr (Length > 0) {
+            (void)length;
+            bool match = true;
+            for (int k = 0; k < Length; ++k) {
+                match &= lowercase(cell[k * step]) == word[k];
+            }
+            return match;
+        }
+        else {
+            for (int k = 0; k < length; ++k) {
+                if (lowercase(cell[k * step]) != word[k]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    //-------------------------------------------------------
+    // placeAt writes word from (row, col) in Direction when
+    // every cell on the way is empty (' ') or already holds
+    // the same letter. The word must fit.
+    //-------------------------------------------------------
+    template <int Direction, int Length>
+    bool placeAt(std::string_view word, CharGrid& grid, int row, int col) {
+        char* cell = grid.rowData(row) + col;
+        const std::ptrdiff_t step = directionStep<Direction>(grid);
+        const int length = Length > 0 ? Length : static_cast<int>(word.length());
+        bool fits = true;
+        if constexpr (Length > 0) {
+            for (int k = 0; k < Length; ++k) {
+                char ch = cell[k * step];
+                fits &= (ch == ' ') | (ch == word[k]);
+            }
+        }
+        else {
+            for (int k = 0; k < length && fits; ++k) {
+                char ch = cell[k * step];
+                fits = ch == ' ' || ch == word[k];
+            }
+        }
+        if (fits) {
+            for (int k = 0; k < length; ++k) {
+                cell[k * step] = word[k];
+            }
+        }
+        return fits;
+    }
+
+    using PlaceKernel = bool (*)(std::string_view word, CharGrid& grid, int row, int col);
+
+    template <int Length, int... Directions>
+    constexpr std::array<PlaceKernel, NUM_DIRECTIONS> placeKernelsFor(std::integer_sequence<int, Directions...>) {
+        return { { &placeAt<Directions, Length>... } };
+    }
+
+    // placeAt for every direction, indexed by direction
+    template <int Length>
+    constexpr std::array<PlaceKernel, NUM_DIRECTIONS> PLACE_KERNELS = placeKernelsFor<Length>(std::make_integer_sequence<int, NUM_DIRECTIONS>());
+
+    // Placement kernels for a word length, chosen once per populateGrid
+    inline const std::array<PlaceKernel, NUM_DIRECTIONS>& placeKernels(int length) {
+        switch (length) {
+        case 2: return PLACE_KERNELS<2>;
+        case 3: return PLACE_KERNELS<3>;
+        case 4: return PLACE_KERNELS<4>;
+        case 5: return PLACE_KERNELS<5>;
+        case 6: return PLACE_KERNELS<6>;
+        case 7: return PLACE_KERNELS<7>;
+        default: return PLACE_KERNELS<0>;
+        }
+    }
+
+    // Rows [firstRow, endRow) and columns [firstCol, endCol) of a grid
+    struct CellRange {
+        int firstRow;
+        int endRow;
+        int firstCol;
+        int endCol;
+    };
+
+    //-------------------------------------------------------
+    // scanGrid finds the first start of a lowercase word in
+    // row-major, then direction, order among the starts in
+    // 'starts'; the word may run outside them but not out
+    // of the grid. Each cell tries the directions in turn
+    // through an unrolled fold, so the order matches a
+    // plain loop over directions.
+    // 'probes' counts the starts that fit.
+    //-------------------------------------------------------
+    template <int Length, int... Directions>
+    bool scanGrid(const char* word, int length, const CharGrid& grid, const CellRange& starts, WordMatch& match,
+        std::uint64_t& probes, std::integer_sequence<int, Directions...>) {
+        const int size = grid.size();
+        for (int row = starts.firstRow; row < starts.endRow; ++row) {
+            for (int col = starts.firstCol; col < starts.endCol; ++col) {
+                int found = -1;
+                ((fitsFrom<Directions>(row, col, size, length) && (++probes, matchesAt<Directions, Length>(word, length, grid, row, col))
+                    && (found = Directions, true)) || ...);
+                if (found >= 0) {
+                    match = WordMatch{ row, col, found, -1 };
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // scanGrid over 'starts' with the kernel for the word's length
+    inline bool scanGrid(const char* word, int length, const CharGrid& grid, const CellRange& starts, WordMatch& match, std::uint64_t& probes) {
+        auto directions = std::make_integer_sequence<int, NUM_DIRECTIONS>();
+        switch (length) {
+        case 2: return scanGrid<2>(word, length, grid, starts, match, probes, directions);
+        case 3: return scanGrid<3>(word, length, grid, starts, match, probes, directions);
+        case 4: return scanGrid<4>(word, length, grid, starts, match, probes, directions);
+        case 5: return scanGrid<5>(word, length, grid, starts, match, probes, directions);
+        case 6: return scanGrid<6>(word, length, grid, starts, match, probes, directions);
+        case 7: return scanGrid<7>(word, length, grid, starts, match, probes, directions);
+        default: return scanGrid<0>(word, length, grid, starts, match, probes, directions);
+        }
+    }
+
+    // scanGrid over every cell
+    inline bool scanGrid(const char* word, int length, const CharGrid& grid, WordMatch& match, std::uint64_t& probes) {
+        return scanGrid(word, length, grid, CellRange{ 0, grid.size(), 0, grid.size() }, match, probes);
+    }
+
+} // namespace WordGame
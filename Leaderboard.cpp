@@ -0,0 +1,176 @@
+#include "header.h"
+
+namespace WordGame {
+
+    //------------------------------------------------------------------------------
+    // ahead
+    // Rank order: higher score first, then the earlier game, then the player
+    // id, so no two entries tie.
+    //------------------------------------------------------------------------------
+    bool Leaderboard::ahead(const ScoreEntry& a, const ScoreEntry& b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        if (a.time != b.time) {
+            return a.time < b.time;
+        }
+        return a.player < b.player;
+    }
+
+    //------------------------------------------------------------------------------
+    // split
+    // Cuts the subtree at 'node' into the nodes ranked ahead of key and the
+    // rest. keyGoesLeft also sends a node equal to key to the left.
+    //------------------------------------------------------------------------------
+    void Leaderboard::split(int node, const ScoreEntry& key, bool keyGoesLeft, int& left, int& right) {
+        if (node < 0) {
+            left = right = -1;
+            return;
+        }
+        const ScoreEntry& entry = nodes[node].entry;
+        bool goesLeft = ahead(entry, key) || (keyGoesLeft && !ahead(key, entry));
+        if (goesLeft) {
+            split(nodes[node].right, key, keyGoesLeft, nodes[node].right, right);
+            left = node;
+        }
+        else {
+            split(nodes[node].left, key, keyGoesLeft, left, nodes[node].left);
+            right = node;
+        }
+        update(node);
+    }
+
+    int Leaderboard::merge(int left, int right) {
+        if (left < 0 || right < 0) {
+            return left < 0 ? right : left;
+        }
+        if (nodes[left].priority > nodes[right].priority) {
+            nodes[left].right = merge(nodes[left].right, right);
+            update(left);
+            return left;
+        }
+        nodes[right].left = merge(left, nodes[right].left);
+        update(right);
+        return right;
+    }
+
+    void Leaderboard::insert(const ScoreEntry& entry) {
+        int node;
+        if (!freeNodes.empty()) {
+            node = freeNodes.back();
+            freeNodes.pop_back();
+        }
+        else {
+            node = static_cast<int>(nodes.size());
+            nodes.emplace_back();
+        }
+        nodes[node] = Node{ entry, static_cast<std::uint32_t>(priorities.next()), -1, -1, 1 };
+
+        int left, right;
+        split(root, entry, false, left, right);
+        root = merge(merge(left, node), right);
+        byPlayer[entry.player] = node;
+    }
+
+    // Removes the node holding exactly this entry
+    void Leaderboard::erase(const ScoreEntry& entry) {
+        int left, middle, right;
+        split(root, entry, false, left, right);
+        split(right, entry, true, middle, right);
+        if (middle >= 0) {
+            freeNodes.push_back(middle);
+        }
+        root = merge(left, right);
+    }
+
+    //------------------------------------------------------------------------------
+    // submit
+    // A player holds one place on the board, at their best score. A better
+    // score moves them: the old node is cut out and the new one inserted.
+    //------------------------------------------------------------------------------
+    bool Leaderboard::submit(const ScoreEntry& entry) {
+        auto existing = byPlayer.find(entry.player);
+        if (existing != byPlayer.end()) {
+            ScoreEntry previous = nodes[existing->second].entry;
+            if (entry.score <= previous.score) {
+                return false;
+            }
+            erase(previous);
+        }
+        insert(entry);
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    // top
+    // In-order walk that stops after 'count' nodes.
+    //------------------------------------------------------------------------------
+    std::vector<ScoreEntry> Leaderboard::top(int count) const {
+        std::vector<ScoreEntry> entries;
+        if (count <= 0) {
+            return entries;
+        }
+        entries.reserve(static_cast<std::size_t>(std::min(count, size())));
+        std::vector<int> path;
+        int node = root;
+        while ((node >= 0 || !path.empty()) && static_cast<int>(entries.size()) < count) {
+            while (node >= 0) {
+                path.push_back(node);
+                node = nodes[node].left;
+            }
+            node = path.back();
+            path.pop_back();
+            entries.push_back(nodes[node].entry);
+            node = nodes[node].right;
+        }
+        return entries;
+    }
+
+    //------------------------------------------------------------------------------
+    // rank
+    // Walks from the root towards the player's entry, adding up the subtrees
+    // ranked ahead of it.
+    //------------------------------------------------------------------------------
+    int Leaderboard::rank(std::uint64_t player) const {
+        const ScoreEntry* entry = best(player);
+        if (entry == nullptr) {
+            return 0;
+        }
+        int placesAhead = 0;
+        int node = root;
+        while (node >= 0) {
+            const ScoreEntry& here = nodes[node].entry;
+            if (ahead(here, *entry)) {
+                placesAhead += countOf(nodes[node].left) + 1;
+                node = nodes[node].right;
+            }
+            else if (ahead(*entry, here)) {
+                node = nodes[node].left;
+            }
+            else {
+                return placesAhead + countOf(nodes[node].left) + 1;
+            }
+        }
+        return 0;
+    }
+
+    double Leaderboard::percentile(std::uint64_t player) const {
+        int place = rank(player);
+        if (place == 0) {
+            return 0.0;
+        }
+        return 100.0 * (size() - place + 1) / size();
+    }
+
+    const ScoreEntry* Leaderboard::best(std::uint64_t player) const {
+        auto found = byPlayer.find(player);
+        return found == byPlayer.end() ? nullptr : &nodes[found->second].entry;
+    }
+
+    void Leaderboard::forEach(const std::function<void(const ScoreEntry&)>& fn) const {
+        for (const auto& entry : byPlayer) {
+            fn(nodes[entry.second].entry);
+        }
+    }
+
+} // namespace WordGame
@@ -1,9 +1,11 @@
 #include "header.h"
-int main() {
-    system("color FC");
+int main(int argc, char* argv[]) {
     using namespace WordGame;
-    srand(static_cast<unsigned int>(time(0)));
+    if (argc > 1) {
+        return runCommandLine(argc, argv);
+    }
+    system("color FC");
     Game game;
     game.displayMenu();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,78 @@
+#include "header.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WORDGAME_HAVE_MMAP 1
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace WordGame {
+
+    //------------------------------------------------------------------------------
+    // open
+    // Maps regular, non-empty files. Pipes, devices and anything mmap refuses
+    // are read to the end into a buffer, so the caller sees the same interface
+    // either way.
+    //------------------------------------------------------------------------------
+    std::shared_ptr<const MappedFile> MappedFile::open(const std::string& path) {
+        std::shared_ptr<MappedFile> file(new MappedFile());
+
+#ifdef WORDGAME_HAVE_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open file " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            void* address = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED) {
+                madvise(address, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+                file->bytes = static_cast<const char*>(address);
+                file->length = static_cast<std::size_t>(info.st_size);
+                file->mapped = true;
+                ::close(fd);
+                return file;
+            }
+        }
+
+        char chunk[65536];
+        for (;;) {
+            ssize_t got = ::read(fd, chunk, sizeof(chunk));
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got < 0) {
+                ::close(fd);
+                throw std::runtime_error("Could not read file " + path);
+            }
+            if (got == 0) {
+                break;
+            }
+            file->buffer.insert(file->buffer.end(), chunk, chunk + got);
+        }
+        ::close(fd);
+#else
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) {
+            throw std::runtime_error("Could not open file " + path);
+        }
+        file->buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+#endif
+
+        file->bytes = file->buffer.data();
+        file->length = file->buffer.size();
+        return file;
+    }
+
+    MappedFile::~MappedFile() {
+#ifdef WORDGAME_HAVE_MMAP
+        if (mapped) {
+            munmap(const_cast<char*>(bytes), length);
+        }
+#endif
+    }
+
+} // namespace WordGame
@@ -0,0 +1,230 @@
+#include "header.h"
+#include <atomic>
+#include <exception>
+
+namespace WordGame {
+
+    namespace {
+
+        // Indices [begin, end) still owned by one worker
+        struct WorkSlice {
+            std::mutex lock;
+            int begin = 0;
+            int end = 0;
+        };
+
+        //--------------------------------------------------------------------------
+        // ParallelTask is one parallelFor call as the pool sees it. Helpers
+        // that start after the caller has finished its own share find the task
+        // closed and leave without touching it, so the caller only waits for
+        // helpers already running and never for queued ones. That also keeps a
+        // parallelFor inside a pool thread from waiting on itself.
+        //--------------------------------------------------------------------------
+        struct ParallelTask {
+            std::mutex lock;
+            std::condition_variable idle;
+            std::function<void(int)> work; // Runs one worker's share, by worker number
+            int nextWorker = 1; // Worker 0 is the caller
+            int active = 0; // Helpers running work
+            bool closed = false;
+        };
+
+        //--------------------------------------------------------------------------
+        // WorkerPool keeps threads alive between parallelFor calls, so a call
+        // costs a queue push and a wake-up per helper instead of a thread start
+        // and join. It grows to the most helpers any call has asked for.
+        //--------------------------------------------------------------------------
+        class WorkerPool {
+        public:
+            static WorkerPool& instance() {
+                static WorkerPool pool;
+                return pool;
+            }
+
+            ~WorkerPool() {
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    stopping = true;
+                }
+                ready.notify_all();
+                for (std::thread& worker : workers) {
+                    worker.join();
+                }
+            }
+
+            // Queues 'helpers' entries for the task
+            void submit(const std::shared_ptr<ParallelTask>& task, int helpers) {
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    while (static_cast<int>(workers.size()) < helpers) {
+                        workers.emplace_back(&WorkerPool::run, this);
+                    }
+                    for (int h = 0; h < helpers; ++h) {
+                        queue.push_back(task);
+                    }
+                }
+                if (helpers == 1) {
+                    ready.notify_one();
+                }
+                else {
+                    ready.notify_all();
+                }
+            }
+
+        private:
+            WorkerPool() = default;
+
+            void run() {
+                for (;;) {
+                    std::shared_ptr<ParallelTask> task;
+                    {
+                        std::unique_lock<std::mutex> guard(lock);
+                        ready.wait(guard, [this] { return stopping || !queue.empty(); });
+                        if (queue.empty()) {
+                            return;
+                        }
+                        task = std::move(queue.front());
+                        queue.pop_front();
+                    }
+                    help(*task);
+                }
+            }
+
+            static void help(ParallelTask& task) {
+                int self;
+                {
+                    std::lock_guard<std::mutex> guard(task.lock);
+                    if (task.closed) {
+                        return;
+                    }
+                    self = task.nextWorker++;
+                    ++task.active;
+                }
+                task.work(self);
+                std::lock_guard<std::mutex> guard(task.lock);
+                if (--task.active == 0) {
+                    task.idle.notify_all();
+                }
+            }
+
+            std::mutex lock;
+            std::condition_variable ready;
+            std::deque<std::shared_ptr<ParallelTask>> queue;
+            std::vector<std::thread> workers;
+            bool stopping = false;
+        };
+
+    } // namespace
+
+    // Asked once: hardware_concurrency() costs a system call on Linux
+    int hardwareThreads() {
+        static const int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        return threads;
+    }
+
+    //------------------------------------------------------------------------------
+    // parallelFor
+    // Owners take indices from the front of their slice and thieves split off
+    // the back, so the two only meet on the slice's lock. The caller is worker
+    // 0 and the rest come from the pool; a helper that starts late finds every
+    // slice empty, or the task closed, and leaves.
+    //------------------------------------------------------------------------------
+    void parallelFor(int count, int threads, const std::function<void(int)>& body) {
+        if (count <= 0) {
+            return;
+        }
+        if (threads <= 0) {
+            threads = hardwareThreads();
+        }
+        threads = std::min(threads, count);
+        if (threads == 1) {
+            for (int index = 0; index < count; ++index) {
+                body(index);
+            }
+            return;
+        }
+
+        std::unique_ptr<WorkSlice[]> slices(new WorkSlice[threads]);
+        for (int w = 0; w < threads; ++w) {
+            slices[w].begin = static_cast<int>(static_cast<long long>(count) * w / threads);
+            slices[w].end = static_cast<int>(static_cast<long long>(count) * (w + 1) / threads);
+        }
+        std::atomic<bool> failed(false);
+        std::exception_ptr error;
+        std::mutex errorLock;
+
+        auto steal = [&](int thief) {
+            int victim = -1, largest = 0;
+            for (int w = 0; w < threads; ++w) {
+                if (w == thief) {
+                    continue;
+                }
+                std::lock_guard<std::mutex> guard(slices[w].lock);
+                if (slices[w].end - slices[w].begin > largest) {
+                    largest = slices[w].end - slices[w].begin;
+                    victim = w;
+                }
+            }
+            if (victim < 0) {
+                return false;
+            }
+            int begin, end;
+            {
+                std::lock_guard<std::mutex> guard(slices[victim].lock);
+                int left = slices[victim].end - slices[victim].begin;
+                if (left <= 0) {
+                    return true; // Emptied meanwhile, look again
+                }
+                end = slices[victim].end;
+                begin = end - (left + 1) / 2;
+                slices[victim].end = begin;
+            }
+            std::lock_guard<std::mutex> guard(slices[thief].lock);
+            slices[thief].begin = begin;
+            slices[thief].end = end;
+            return true;
+        };
+
+        auto work = [&](int self) {
+            while (!failed.load(std::memory_order_relaxed)) {
+                int index = -1;
+                {
+                    std::lock_guard<std::mutex> guard(slices[self].lock);
+                    if (slices[self].begin < slices[self].end) {
+                        index = slices[self].begin++;
+                    }
+                }
+                if (index < 0) {
+                    if (!steal(self)) {
+                        return;
+                    }
+                    continue;
+                }
+                try {
+                    body(index);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> guard(errorLock);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        std::shared_ptr<ParallelTask> task = std::make_shared<ParallelTask>();
+        task->work = work;
+        WorkerPool::instance().submit(task, threads - 1);
+        work(0);
+        {
+            std::unique_lock<std::mutex> guard(task->lock);
+            task->closed = true;
+            task->idle.wait(guard, [&] { return task->active == 0; });
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+} // namespace WordGame
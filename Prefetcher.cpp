@@ -0,0 +1,88 @@
+#include "header.h"
+#include <system_error>
+
+namespace WordGame {
+
+    GridPrefetcher::~GridPrefetcher() {
+        for (Job& job : jobs) {
+            job.puzzle.wait();
+        }
+        for (std::future<Puzzle>& puzzle : dropped) {
+            puzzle.wait();
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // prefetch
+    // Starts a worker for the level's grid. Every job gets its own seed, so a
+    // retry grid differs from the one it replaces. If no thread can be
+    // started, take() builds the grid itself later.
+    //------------------------------------------------------------------------------
+    void GridPrefetcher::prefetch(int level) {
+        reap();
+        for (const Job& job : jobs) {
+            if (job.level == level) {
+                return;
+            }
+        }
+
+        std::uint64_t jobSeed = Random::deriveSeed(seed, jobsStarted++);
+        const GameMode& source = mode;
+        const Dictionary& dictionary = words;
+        try {
+            jobs.push_back(Job{ level, std::async(std::launch::async, [&source, &dictionary, level, jobSeed]() {
+                Random random(jobSeed);
+                return source.makePuzzle(dictionary, level, random);
+            }) });
+        }
+        catch (const std::system_error&) {
+            // No worker available, take() will build this grid
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // take
+    // Hands over the oldest grid requested for the level, waiting for it if it
+    // is still being built. Levels only go up, so grids for lower levels are
+    // dropped; they finish in the background and are reaped later. Errors are
+    // reported and give an empty puzzle, like a failed Grid() call.
+    //------------------------------------------------------------------------------
+    Puzzle GridPrefetcher::take(int level) {
+        reap();
+        std::future<Puzzle> ready;
+        for (auto job = jobs.begin(); job != jobs.end(); ) {
+            if (job->level < level) {
+                dropped.push_back(std::move(job->puzzle));
+                job = jobs.erase(job);
+            }
+            else if (job->level == level && !ready.valid()) {
+                ready = std::move(job->puzzle);
+                job = jobs.erase(job);
+            }
+            else {
+                ++job;
+            }
+        }
+
+        try {
+            if (ready.valid()) {
+                return ready.get();
+            }
+            Random random(Random::deriveSeed(seed, jobsStarted++));
+            return mode.makePuzzle(words, level, random);
+        }
+        catch (const std::exception& e) {
+            std::cout << "Error: " << e.what() << std::endl;
+            Puzzle failed;
+            failed.level = level;
+            return failed;
+        }
+    }
+
+    void GridPrefetcher::reap() {
+        dropped.erase(std::remove_if(dropped.begin(), dropped.end(), [](const std::future<Puzzle>& puzzle) {
+            return puzzle.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }), dropped.end());
+    }
+
+} // namespace WordGame
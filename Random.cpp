@@ -0,0 +1,83 @@
+#include "header.h"
+#include <random>
+
+namespace WordGame {
+
+    namespace {
+
+        // SplitMix64 step, used to spread a seed over the generator state
+        std::uint64_t splitMix(std::uint64_t& value) {
+            std::uint64_t z = (value += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+    } // namespace
+
+    void Random::reseed(std::uint64_t seed) {
+        for (std::uint64_t& word : state) {
+            word = splitMix(seed);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // below
+    // Multiply-shift reduction of a 32-bit draw, rejecting the few low products
+    // that would make small values more likely than large ones.
+    //------------------------------------------------------------------------------
+    int Random::below(int bound) {
+        std::uint32_t range = static_cast<std::uint32_t>(bound);
+        std::uint64_t product = (next() >> 32) * range;
+        std::uint32_t low = static_cast<std::uint32_t>(product);
+        if (low < range) {
+            std::uint32_t threshold = (0u - range) % range;
+            while (low < threshold) {
+                product = (next() >> 32) * range;
+                low = static_cast<std::uint32_t>(product);
+            }
+        }
+        return static_cast<int>(product >> 32);
+    }
+
+    //------------------------------------------------------------------------------
+    // fillLetters
+    // Cuts each 64-bit draw into four 16-bit pieces and scales every piece to
+    // a letter, so filling a row costs a quarter of a draw per cell.
+    //------------------------------------------------------------------------------
+    void Random::fillLetters(char* out, std::size_t count) {
+        std::size_t i = 0;
+        while (i < count) {
+            std::uint64_t bits = next();
+            for (int piece = 0; piece < 4 && i < count; ++piece, ++i) {
+                out[i] = static_cast<char>('a' + (((bits & 0xFFFF) * ALPHABET_SIZE) >> 16));
+                bits >>= 16;
+            }
+        }
+    }
+
+    std::uint64_t Random::freshSeed() {
+        std::uint64_t seed = static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        seed ^= static_cast<std::uint64_t>(std::time(nullptr)) << 32;
+        try {
+            std::random_device device;
+            seed ^= (static_cast<std::uint64_t>(device()) << 32) | device();
+        }
+        catch (const std::exception&) {
+            // The clock alone is enough for play
+        }
+        return splitMix(seed);
+    }
+
+    //------------------------------------------------------------------------------
+    // deriveSeed
+    // Gives every item of a batch its own seed, so an item's output depends
+    // on the batch seed and its position only, not on which thread made it.
+    //------------------------------------------------------------------------------
+    std::uint64_t Random::deriveSeed(std::uint64_t base, std::uint64_t index) {
+        std::uint64_t mixed = splitMix(index);
+        mixed ^= base;
+        return splitMix(mixed);
+    }
+
+} // namespace WordGame
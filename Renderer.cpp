@@ -0,0 +1,244 @@
+#include "header.h"
+#include "Stats.h"
+#include <charconv>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WORDGAME_HAVE_TERMINAL 1
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace WordGame {
+
+    namespace {
+
+        int digitCount(int value) {
+            int digits = 1;
+            while (value >= 10) {
+                value /= 10;
+                ++digits;
+            }
+            return digits;
+        }
+
+        void appendNumber(std::string& out, int value) {
+            char digits[12];
+            std::to_chars_result end = std::to_chars(digits, digits + sizeof(digits), value);
+            out.append(digits, end.ptr);
+        }
+
+        const int ROW_LABEL_GAP = 1; // Space between a row number and its first cell
+        const int CELL_WIDTH = 5; // " | x "
+        const int CELL_LETTER = 3; // Offset of the letter inside a cell
+
+        // Letter drawn for a cell: its capital once the cell is found
+        char shownLetter(const CharGrid& grid, const CellMask* found, int row, int col) {
+            char ch = grid.at(row, col);
+            if (found != nullptr && ch >= 'a' && ch <= 'z' && found->test(row, col)) {
+                ch = static_cast<char>(ch - 'a' + 'A');
+            }
+            return ch;
+        }
+
+        // A found cell's letter in reverse video, any other as is
+        void appendLetter(std::string& out, char ch, bool highlight) {
+            if (highlight) {
+                out += "\033[7m";
+                out += ch;
+                out += "\033[27m";
+            }
+            else {
+                out += ch;
+            }
+        }
+
+    } // namespace
+
+    //------------------------------------------------------------------------------
+    // terminalSize
+    // Rows and columns of the terminal on stdout. Fails when stdout is not a
+    // terminal, or on platforms without the ioctl, which then get plain text.
+    //------------------------------------------------------------------------------
+    bool GridRenderer::terminalSize(int& rows, int& cols) {
+#ifdef WORDGAME_HAVE_TERMINAL
+        winsize size;
+        if (isatty(STDOUT_FILENO) && ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0) {
+            rows = size.ws_row;
+            cols = size.ws_col;
+            return true;
+        }
+#endif
+        return false;
+    }
+
+    //------------------------------------------------------------------------------
+    // appendLine
+    // Line 'line' of the bordered grid for rows [firstRow, firstRow + rowCount)
+    // and columns [firstCol, firstCol + colCount): column numbers, then a
+    // border and a letter row per grid row, then a closing border. Without a
+    // newline. Found cells are capitals, highlighted as well on a terminal.
+    //------------------------------------------------------------------------------
+    void GridRenderer::appendLine(std::string& out, const CharGrid& grid, const CellMask* found, bool terminal, int line, int firstRow, int rowCount,
+        int firstCol, int colCount) {
+        if (line == 0) {
+            out += "   ";
+            for (int col = firstCol; col < firstCol + colCount; ++col) {
+                out += "  ";
+                appendNumber(out, col);
+                out += "  ";
+            }
+            return;
+        }
+        if (line % 2 == 1) {
+            out += line == 2 * rowCount + 1 ? "  " : " ";
+            for (int k = 0; k < colCount; ++k) {
+                out += " - - ";
+            }
+            return;
+        }
+
+        int row = firstRow + line / 2 - 1;
+        appendNumber(out, row);
+        out += ' ';
+        const char* letters = grid.rowData(row);
+        for (int col = firstCol; col < firstCol + colCount; ++col) {
+            out += " | ";
+            if (found != nullptr && found->test(row, col)) {
+                appendLetter(out, shownLetter(grid, found, row, col), terminal);
+            }
+            else {
+                out += letters[col];
+            }
+            out += ' ';
+        }
+        out += '|';
+    }
+
+    void GridRenderer::appendGrid(std::string& out, const CharGrid& grid, const CellMask* found) {
+        int size = grid.size();
+        int lines = 2 * size + 2;
+        out.reserve(out.size() + static_cast<std::size_t>(lines) * (CELL_WIDTH * size + 2 * size + 8));
+        for (int line = 0; line < lines; ++line) {
+            appendLine(out, grid, found, false, line, 0, size, 0, size);
+            out += '\n';
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // layout
+    // Fits the grid into the terminal below screen row 'top', leaving
+    // 'reservedRows' under it for messages. A grid that does not fit is
+    // clipped to a viewport at its top-left corner. Everything on screen is
+    // forgotten, so the next draw must be drawFrame().
+    //------------------------------------------------------------------------------
+    void GridRenderer::layout(int size, int firstLine, int screenRows, int screenCols, int reservedRows) {
+        gridSize = size;
+        top = firstLine;
+        viewRow = 0;
+        viewCol = 0;
+
+        int labelWidth = digitCount(size - 1);
+        int fitRows = (screenRows - top + 1 - reservedRows - 2) / 2;
+        int fitCols = std::min((screenCols - 1 - labelWidth - ROW_LABEL_GAP - 1) / CELL_WIDTH, // Letter rows
+            (screenCols - 1 - 3) / (4 + labelWidth)); // Column numbers
+        viewRows = std::max(1, std::min(size, fitRows));
+        viewCols = std::max(1, std::min(size, fitCols));
+
+        shown.assign(static_cast<std::size_t>(size) * size, '\0');
+        std::size_t lineBytes = static_cast<std::size_t>(viewCols) * (4 + labelWidth) + labelWidth + 16;
+        frame.reserve(static_cast<std::size_t>(2 * viewRows + 3) * lineBytes);
+    }
+
+    //------------------------------------------------------------------------------
+    // drawFrame
+    // Every line of the viewport, each placed with a cursor move and cleared
+    // to its end, followed by a move to the first row under the grid.
+    //------------------------------------------------------------------------------
+    const std::string& GridRenderer::drawFrame(const CharGrid& grid, const CellMask* found) {
+        frame.clear();
+        int lines = 2 * viewRows + 2;
+        for (int line = 0; line < lines; ++line) {
+            appendMoveTo(top + line, 1);
+            appendLine(frame, grid, found, true, line, viewRow, viewRows, viewCol, viewCols);
+            frame += "\033[K";
+        }
+        appendMoveTo(bottom(), 1);
+
+        for (int i = viewRow; i < viewRow + viewRows; ++i) {
+            for (int j = viewCol; j < viewCol + viewCols; ++j) {
+                shown[static_cast<std::size_t>(i) * gridSize + j] = shownLetter(grid, found, i, j);
+            }
+        }
+        WORDGAME_RECORD(RenderBytes, frame.size());
+        return frame;
+    }
+
+    //------------------------------------------------------------------------------
+    // drawChanges
+    // Visible cells whose letter differs from what was last drawn, each behind
+    // a cursor move. A newly found cell differs, since it is drawn as a
+    // capital. The cursor is saved before and restored after, so the patch can
+    // be sent in the middle of other output. Empty if nothing changed.
+    //------------------------------------------------------------------------------
+    const std::string& GridRenderer::drawChanges(const CharGrid& grid, const CellMask* found) {
+        frame.clear();
+        for (int i = viewRow; i < viewRow + viewRows; ++i) {
+            int line = top + 2 + 2 * (i - viewRow);
+            int labelWidth = digitCount(i);
+            for (int j = viewCol; j < viewCol + viewCols; ++j) {
+                char ch = shownLetter(grid, found, i, j);
+                char& onScreen = shown[static_cast<std::size_t>(i) * gridSize + j];
+                if (ch == onScreen) {
+                    continue;
+                }
+                if (frame.empty()) {
+                    frame += "\0337";
+                }
+                appendMoveTo(line, labelWidth + ROW_LABEL_GAP + CELL_WIDTH * (j - viewCol) + CELL_LETTER + 1);
+                appendLetter(frame, ch, found != nullptr && found->test(i, j));
+                onScreen = ch;
+            }
+        }
+        if (!frame.empty()) {
+            frame += "\0338";
+        }
+        WORDGAME_RECORD(RenderBytes, frame.size());
+        return frame;
+    }
+
+    //------------------------------------------------------------------------------
+    // scroll
+    // Moves the viewport by half its size per step, staying inside the grid.
+    // Returns false if it did not move.
+    //------------------------------------------------------------------------------
+    bool GridRenderer::scroll(int rowSteps, int colSteps) {
+        int row = viewRow + rowSteps * std::max(1, viewRows / 2);
+        int col = viewCol + colSteps * std::max(1, viewCols / 2);
+        row = std::max(0, std::min(row, gridSize - viewRows));
+        col = std::max(0, std::min(col, gridSize - viewCols));
+        if (row == viewRow && col == viewCol) {
+            return false;
+        }
+        viewRow = row;
+        viewCol = col;
+        return true;
+    }
+
+    std::string GridRenderer::clearBelow() const {
+        return "\033[" + std::to_string(bottom()) + ";1H\033[J";
+    }
+
+    void GridRenderer::describeViewport(std::ostream& out) const {
+        out << "Rows " << viewRow << "-" << (viewRow + viewRows - 1) << ", columns " << viewCol << "-"
+            << (viewCol + viewCols - 1) << " of " << gridSize << " (:w :a :s :d to scroll)\n";
+    }
+
+    void GridRenderer::appendMoveTo(int row, int col) {
+        frame += "\033[";
+        appendNumber(frame, row);
+        frame += ';';
+        appendNumber(frame, col);
+        frame += 'H';
+    }
+
+} // namespace WordGame
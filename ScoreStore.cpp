@@ -0,0 +1,450 @@
+#include "header.h"
+#include "Stats.h"
+#include <cstdio>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WORDGAME_HAVE_POSIX_FILES 1
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace WordGame {
+
+    namespace {
+
+        //--------------------------------------------------------------------------
+        // Score file layout (host byte order, like compiled dictionaries):
+        //   FileHeader
+        //   DiskRecord[...]                 until the end of the file
+        // The log and the snapshot share it. Each record carries a CRC-32 of
+        // its other bytes; replay stops at the first record that is short or
+        // fails its check, which is where a crash cut an append.
+        //--------------------------------------------------------------------------
+        const char SCORES_MAGIC[8] = { 'W', 'G', 'S', 'C', 'O', 'R', 'E', '\n' };
+        const std::uint32_t SCORES_VERSION = 1;
+        const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+        const std::size_t COMPACT_AFTER = 4096; // Log records that trigger a snapshot
+        const std::chrono::milliseconds GROUP_COMMIT_WINDOW(2); // Lets a burst of appends share one fsync
+
+        struct FileHeader {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t byteOrder; // BYTE_ORDER_MARK as written
+        };
+
+        struct DiskRecord {
+            std::uint32_t checksum; // CRC-32 of the bytes after this field
+            std::uint8_t mode;
+            std::uint8_t level;
+            std::uint16_t reserved;
+            std::int32_t score;
+            std::uint32_t reserved2;
+            std::uint64_t player;
+            std::int64_t time;
+        };
+
+        static_assert(sizeof(FileHeader) == 16, "FileHeader layout changed");
+        static_assert(sizeof(DiskRecord) == 32, "DiskRecord layout changed");
+
+        std::uint32_t crc32(const unsigned char* bytes, std::size_t length) {
+            static const std::vector<std::uint32_t> table = [] {
+                std::vector<std::uint32_t> entries(256);
+                for (std::uint32_t i = 0; i < 256; ++i) {
+                    std::uint32_t value = i;
+                    for (int bit = 0; bit < 8; ++bit) {
+                        value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+                    }
+                    entries[i] = value;
+                }
+                return entries;
+            }();
+            std::uint32_t crc = 0xFFFFFFFFu;
+            for (std::size_t i = 0; i < length; ++i) {
+                crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+            }
+            return crc ^ 0xFFFFFFFFu;
+        }
+
+        std::uint32_t recordChecksum(const DiskRecord& record) {
+            return crc32(reinterpret_cast<const unsigned char*>(&record) + sizeof(record.checksum), sizeof(DiskRecord) - sizeof(record.checksum));
+        }
+
+        DiskRecord encode(const ScoreEntry& entry) {
+            DiskRecord record = {};
+            record.mode = static_cast<std::uint8_t>(entry.mode);
+            record.level = static_cast<std::uint8_t>(entry.level);
+            record.score = entry.score;
+            record.player = entry.player;
+            record.time = entry.time;
+            record.checksum = recordChecksum(record);
+            return record;
+        }
+
+        FileHeader makeHeader() {
+            FileHeader header;
+            std::memcpy(header.magic, SCORES_MAGIC, sizeof(SCORES_MAGIC));
+            header.version = SCORES_VERSION;
+            header.byteOrder = BYTE_ORDER_MARK;
+            return header;
+        }
+
+        int boardKey(int mode, int level) {
+            return mode * 16 + level;
+        }
+
+        bool fileExists(const std::string& path) {
+            std::ifstream file(path, std::ios::binary);
+            return file.is_open();
+        }
+
+#ifdef WORDGAME_HAVE_POSIX_FILES
+        // Writes all of data, retrying short writes
+        bool writeAll(int fd, const char* data, std::size_t length) {
+            while (length > 0) {
+                ssize_t count = ::write(fd, data, length);
+                if (count < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+                data += count;
+                length -= static_cast<std::size_t>(count);
+            }
+            return true;
+        }
+
+        bool syncData(int fd) {
+#ifdef __APPLE__
+            return ::fsync(fd) == 0;
+#else
+            return ::fdatasync(fd) == 0;
+#endif
+        }
+
+        // Makes a rename in the file's directory durable
+        void syncDirectory(const std::string& path) {
+            std::size_t slash = path.find_last_of('/');
+            std::string directory = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+            int fd = ::open(directory.c_str(), O_RDONLY);
+            if (fd >= 0) {
+                ::fsync(fd);
+                ::close(fd);
+            }
+        }
+#endif
+
+    } // namespace
+
+    //------------------------------------------------------------------------------
+    // ScoreStore
+    // Replays the snapshot and then the log, opens the log for appending and
+    // starts the writer. The log is created with its header, synced, before
+    // any game can append to it.
+    //------------------------------------------------------------------------------
+    ScoreStore::ScoreStore(const std::string& basePath)
+        : logPath(basePath + ".log"), snapshotPath(basePath + ".snapshot"), logFd(-1), logRecords(0),
+          appended(0), durable(0), stopping(false), compactRequested(false) {
+        replay(snapshotPath, false);
+        replay(logPath, true);
+
+#ifdef WORDGAME_HAVE_POSIX_FILES
+        logFd = ::open(logPath.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+        if (logFd < 0) {
+            throw std::runtime_error("Could not open file " + logPath + " for writing");
+        }
+        struct stat info;
+        if (fstat(logFd, &info) == 0 && info.st_size == 0) {
+            FileHeader header = makeHeader();
+            if (!writeAll(logFd, reinterpret_cast<const char*>(&header), sizeof(header)) || !syncData(logFd)) {
+                ::close(logFd);
+                throw std::runtime_error("Could not write file " + logPath);
+            }
+        }
+#else
+        if (!fileExists(logPath)) {
+            FileHeader header = makeHeader();
+            std::ofstream out(logPath, std::ios::binary);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+#endif
+        writer = std::thread([this] { writerLoop(); });
+    }
+
+    ScoreStore::~ScoreStore() {
+        {
+            std::lock_guard<std::mutex> guard(queueLock);
+            stopping = true;
+        }
+        wake.notify_one();
+        writer.join();
+#ifdef WORDGAME_HAVE_POSIX_FILES
+        if (logFd >= 0) {
+            ::close(logFd);
+        }
+#endif
+    }
+
+    ScoreStore& ScoreStore::instance() {
+        static ScoreStore store("scores");
+        return store;
+    }
+
+    //------------------------------------------------------------------------------
+    // replay
+    // Applies every intact record of a score file. For the log, a torn or
+    // corrupt tail is cut off so that new appends follow the last good record
+    // instead of being hidden behind it.
+    //------------------------------------------------------------------------------
+    void ScoreStore::replay(const std::string& path, bool truncateTornTail) {
+        if (!fileExists(path)) {
+            return;
+        }
+        WORDGAME_TIME(ScoreReadTime);
+        std::shared_ptr<const MappedFile> file = MappedFile::open(path);
+        if (file->size() < sizeof(FileHeader)) {
+            if (truncateTornTail) {
+                std::remove(path.c_str()); // Crashed while creating it; start over
+            }
+            return;
+        }
+        FileHeader header;
+        std::memcpy(&header, file->data(), sizeof(header));
+        if (std::memcmp(header.magic, SCORES_MAGIC, sizeof(SCORES_MAGIC)) != 0 || header.version != SCORES_VERSION ||
+            header.byteOrder != BYTE_ORDER_MARK) {
+            throw std::runtime_error("Unrecognized score file " + path);
+        }
+
+        std::size_t offset = sizeof(FileHeader);
+        std::size_t records = 0;
+        while (offset + sizeof(DiskRecord) <= file->size()) {
+            DiskRecord record;
+            std::memcpy(&record, file->data() + offset, sizeof(record));
+            if (record.checksum != recordChecksum(record)) {
+                break;
+            }
+            apply(ScoreEntry{ record.mode, record.level, record.player, record.score, record.time });
+            offset += sizeof(DiskRecord);
+            ++records;
+        }
+        if (truncateTornTail) {
+            logRecords = records;
+        }
+
+        if (truncateTornTail && offset < file->size()) {
+            std::cerr << "Warning: dropping " << file->size() - offset << " damaged bytes at the end of " << path << std::endl;
+            file.reset();
+#ifdef WORDGAME_HAVE_POSIX_FILES
+            if (::truncate(path.c_str(), static_cast<off_t>(offset)) != 0) {
+                throw std::runtime_error("Could not repair file " + path);
+            }
+#endif
+        }
+    }
+
+    void ScoreStore::apply(const ScoreEntry& entry) {
+        std::lock_guard<std::mutex> guard(stateLock);
+        boards[boardKey(entry.mode, entry.level)].submit(entry);
+    }
+
+    //------------------------------------------------------------------------------
+    // append
+    // Updates the in-memory bests and queues the record. The writer is woken
+    // to commit it; the caller only ever waits for the two short locks.
+    //------------------------------------------------------------------------------
+    void ScoreStore::append(const ScoreEntry& entry) {
+        apply(entry);
+        {
+            std::lock_guard<std::mutex> guard(queueLock);
+            pending.push_back(entry);
+            ++appended;
+        }
+        wake.notify_one();
+    }
+
+    const Leaderboard* ScoreStore::board(int mode, int level) const {
+        auto found = boards.find(boardKey(mode, level));
+        return found == boards.end() ? nullptr : &found->second;
+    }
+
+    std::vector<ScoreEntry> ScoreStore::top(int mode, int level, int count) const {
+        std::lock_guard<std::mutex> guard(stateLock);
+        const Leaderboard* scores = board(mode, level);
+        return scores != nullptr ? scores->top(count) : std::vector<ScoreEntry>();
+    }
+
+    int ScoreStore::rank(int mode, int level, std::uint64_t player) const {
+        std::lock_guard<std::mutex> guard(stateLock);
+        const Leaderboard* scores = board(mode, level);
+        return scores != nullptr ? scores->rank(player) : 0;
+    }
+
+    double ScoreStore::percentile(int mode, int level, std::uint64_t player) const {
+        std::lock_guard<std::mutex> guard(stateLock);
+        const Leaderboard* scores = board(mode, level);
+        return scores != nullptr ? scores->percentile(player) : 0.0;
+    }
+
+    int ScoreStore::boardSize(int mode, int level) const {
+        std::lock_guard<std::mutex> guard(stateLock);
+        const Leaderboard* scores = board(mode, level);
+        return scores != nullptr ? scores->size() : 0;
+    }
+
+    void ScoreStore::sync() {
+        std::unique_lock<std::mutex> guard(queueLock);
+        std::uint64_t target = appended;
+        written.wait(guard, [&] { return durable >= target; });
+    }
+
+    void ScoreStore::compact() {
+        {
+            std::lock_guard<std::mutex> guard(queueLock);
+            compactRequested = true;
+        }
+        wake.notify_one();
+    }
+
+    std::size_t ScoreStore::playerCount() const {
+        std::lock_guard<std::mutex> guard(stateLock);
+        std::size_t count = 0;
+        for (const auto& scores : boards) {
+            count += static_cast<std::size_t>(scores.second.size());
+        }
+        return count;
+    }
+
+    //------------------------------------------------------------------------------
+    // writerLoop
+    // Takes everything queued, after a short window for more to arrive, and
+    // commits it as one batch. Compacts once the log holds COMPACT_AFTER
+    // records or when asked. On stop it drains the queue before returning.
+    //------------------------------------------------------------------------------
+    void ScoreStore::writerLoop() {
+        std::unique_lock<std::mutex> guard(queueLock);
+        for (;;) {
+            wake.wait(guard, [&] { return stopping || compactRequested || !pending.empty(); });
+            if (!stopping && !pending.empty()) {
+                wake.wait_for(guard, GROUP_COMMIT_WINDOW, [&] { return stopping; });
+            }
+            if (stopping && pending.empty() && !compactRequested) {
+                return;
+            }
+            std::vector<ScoreEntry> batch;
+            batch.swap(pending);
+            bool compactNow = compactRequested;
+            compactRequested = false;
+            std::uint64_t covered = appended;
+            guard.unlock();
+
+            if (!batch.empty()) {
+                writeBatch(batch);
+            }
+            if (compactNow || logRecords >= COMPACT_AFTER) {
+                writeSnapshot();
+            }
+
+            guard.lock();
+            durable = covered;
+            written.notify_all();
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // writeBatch
+    // One write for the whole batch followed by one data sync. On an error
+    // the log is cut back to its last good record, so a torn record cannot
+    // hide later batches from replay. The failed batch is reported and is not
+    // on disk; its scores stay in memory until the process ends.
+    //------------------------------------------------------------------------------
+    void ScoreStore::writeBatch(const std::vector<ScoreEntry>& batch) {
+        WORDGAME_TIME(ScoreWriteTime);
+        std::vector<DiskRecord> records;
+        records.reserve(batch.size());
+        for (const ScoreEntry& entry : batch) {
+            records.push_back(encode(entry));
+        }
+        const char* bytes = reinterpret_cast<const char*>(records.data());
+        std::size_t length = records.size() * sizeof(DiskRecord);
+
+#ifdef WORDGAME_HAVE_POSIX_FILES
+        if (!writeAll(logFd, bytes, length) || !syncData(logFd)) {
+            std::cerr << "Error: could not write " << logPath << ": " << std::strerror(errno) << std::endl;
+            off_t good = static_cast<off_t>(sizeof(FileHeader) + logRecords * sizeof(DiskRecord));
+            if (::ftruncate(logFd, good) != 0) {
+                std::cerr << "Error: could not cut " << logPath << " back to its last record: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+#else
+        std::ofstream out(logPath, std::ios::binary | std::ios::app);
+        out.write(bytes, static_cast<std::streamsize>(length));
+        if (!out.flush()) {
+            std::cerr << "Error: could not write " << logPath << std::endl;
+            return;
+        }
+#endif
+        logRecords += records.size();
+    }
+
+    //------------------------------------------------------------------------------
+    // writeSnapshot
+    // Writes every board's bests beside the snapshot, syncs, renames it over
+    // the old one and only then empties the log. A crash before the rename
+    // leaves the old snapshot and the full log; one after it replays the log
+    // over the new snapshot, which changes nothing since only bests are kept.
+    //------------------------------------------------------------------------------
+    void ScoreStore::writeSnapshot() {
+        std::vector<DiskRecord> records;
+        {
+            std::lock_guard<std::mutex> guard(stateLock);
+            for (const auto& scores : boards) {
+                scores.second.forEach([&](const ScoreEntry& entry) { records.push_back(encode(entry)); });
+            }
+        }
+        FileHeader header = makeHeader();
+        std::string tempName = snapshotPath + ".tmp";
+
+#ifdef WORDGAME_HAVE_POSIX_FILES
+        int fd = ::open(tempName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        bool ok = fd >= 0 && writeAll(fd, reinterpret_cast<const char*>(&header), sizeof(header)) &&
+            writeAll(fd, reinterpret_cast<const char*>(records.data()), records.size() * sizeof(DiskRecord)) && ::fsync(fd) == 0;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        if (!ok || std::rename(tempName.c_str(), snapshotPath.c_str()) != 0) {
+            std::cerr << "Error: could not write " << snapshotPath << ": " << std::strerror(errno) << std::endl;
+            std::remove(tempName.c_str());
+            return;
+        }
+        syncDirectory(snapshotPath);
+        if (::ftruncate(logFd, static_cast<off_t>(sizeof(FileHeader))) != 0 || !syncData(logFd)) {
+            std::cerr << "Error: could not truncate " << logPath << ": " << std::strerror(errno) << std::endl;
+            return;
+        }
+#else
+        {
+            std::ofstream out(tempName, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(DiskRecord)));
+            if (!out.flush()) {
+                std::cerr << "Error: could not write " << tempName << std::endl;
+                return;
+            }
+        }
+        std::remove(snapshotPath.c_str());
+        if (std::rename(tempName.c_str(), snapshotPath.c_str()) != 0) {
+            std::cerr << "Error: could not replace " << snapshotPath << std::endl;
+            return;
+        }
+        std::ofstream log(logPath, std::ios::binary | std::ios::trunc);
+        log.write(reinterpret_cast<const char*>(&header), sizeof(header));
+#endif
+        logRecords = 0;
+    }
+
+} // namespace WordGame
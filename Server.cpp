@@ -0,0 +1,443 @@
+#include "header.h"
+#include "Stats.h"
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+
+#ifndef EPOLLEXCLUSIVE
+#define EPOLLEXCLUSIVE 0
+#endif
+#endif
+
+namespace WordGame {
+
+#ifdef __linux__
+
+    namespace {
+
+        const std::size_t READ_CHUNK = 4096; // Bytes read per recv call
+        const std::size_t OUTPUT_HIGH_WATER = 64 * 1024; // Stop reading a client with this much unsent output
+        const int EVENT_BATCH = 256; // Events taken per epoll_wait
+
+        std::atomic<bool> stopRequested(false);
+        std::atomic<bool> statsRequested(false); // SIGUSR1 asks for a statistics snapshot
+
+        void onStopSignal(int) {
+            stopRequested.store(true);
+        }
+
+        void onStatsSignal(int) {
+            statsRequested.store(true);
+        }
+
+        // One client: its session plus unparsed input and unsent output
+        struct Connection {
+            Connection(int fd, std::uint64_t seed) : fd(fd), session(seed, false) {}
+
+            int fd; // -1 once closed
+            GameSession session;
+            std::string input; // Bytes after the last complete line
+            std::string output; // Reply bytes from 'sent' onwards are unsent
+            std::size_t sent = 0;
+            bool closing = false; // Close once the output is flushed
+            std::uint32_t events = 0; // Interest currently registered with epoll
+        };
+
+        //--------------------------------------------------------------------------
+        // EventLoop
+        // Owns an epoll instance and the connections it accepted. Several loops
+        // can share one listening socket; EPOLLEXCLUSIVE wakes only one of them
+        // per incoming connection. All I/O is non-blocking and level-triggered.
+        //--------------------------------------------------------------------------
+        class EventLoop {
+        public:
+            EventLoop(int listener, const ServerOptions& options, std::uint64_t seed);
+            ~EventLoop();
+            EventLoop(const EventLoop&) = delete;
+            EventLoop& operator=(const EventLoop&) = delete;
+
+            bool ready() const { return epollFd >= 0; }
+            void run(); // Serves clients until a stop signal arrives
+
+        private:
+            void acceptClients();
+            void onReadable(Connection& connection);
+            void flush(Connection& connection);
+            void updateInterest(Connection& connection);
+            void close(Connection& connection);
+
+            int epollFd;
+            int listener;
+            int spareFd; // Released to accept-and-drop clients when out of descriptors
+            const ServerOptions& options;
+            Random seeds; // Seeds each new session
+            std::unordered_map<int, std::unique_ptr<Connection>> connections; // By socket
+            std::vector<std::unique_ptr<Connection>> closed; // Freed after the current batch of events
+        };
+
+        EventLoop::EventLoop(int listener, const ServerOptions& options, std::uint64_t seed)
+            : epollFd(epoll_create1(EPOLL_CLOEXEC)), listener(listener), spareFd(::open("/dev/null", O_RDONLY | O_CLOEXEC)),
+              options(options), seeds(seed) {
+            if (epollFd < 0) {
+                return;
+            }
+            epoll_event event = {};
+            event.events = EPOLLIN | EPOLLEXCLUSIVE;
+            event.data.ptr = nullptr; // The listener is the only entry without a connection
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, listener, &event) != 0) {
+                ::close(epollFd);
+                epollFd = -1;
+            }
+        }
+
+        EventLoop::~EventLoop() {
+            for (auto& entry : connections) {
+                ::close(entry.first);
+            }
+            if (spareFd >= 0) {
+                ::close(spareFd);
+            }
+            if (epollFd >= 0) {
+                ::close(epollFd);
+            }
+        }
+
+        void EventLoop::run() {
+            std::vector<epoll_event> events(EVENT_BATCH);
+            while (!stopRequested.load()) {
+                if (statsRequested.exchange(false)) {
+                    std::cerr << Stats::snapshot(Stats::configuredFormat()) << std::flush;
+                }
+                int count = epoll_wait(epollFd, events.data(), EVENT_BATCH, 500);
+                if (count < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    std::cerr << "Error: epoll_wait: " << std::strerror(errno) << std::endl;
+                    return;
+                }
+                for (int i = 0; i < count; ++i) {
+                    Connection* connection = static_cast<Connection*>(events[i].data.ptr);
+                    if (connection == nullptr) {
+                        acceptClients();
+                        continue;
+                    }
+                    if (connection->fd < 0) {
+                        continue; // Closed earlier in this batch
+                    }
+                    if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                        close(*connection);
+                        continue;
+                    }
+                    if (events[i].events & EPOLLOUT) {
+                        flush(*connection);
+                    }
+                    if (connection->fd >= 0 && (events[i].events & EPOLLIN)) {
+                        onReadable(*connection);
+                    }
+                }
+                closed.clear();
+            }
+        }
+
+        //--------------------------------------------------------------------------
+        // acceptClients
+        // Accepts until the backlog is empty. When the process is out of file
+        // descriptors the pending client is accepted on the spare descriptor
+        // and dropped, since leaving it queued would wake the loop forever.
+        //--------------------------------------------------------------------------
+        void EventLoop::acceptClients() {
+            while (true) {
+                int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0) {
+                    if ((errno == EMFILE || errno == ENFILE) && spareFd >= 0) {
+                        ::close(spareFd);
+                        int dropped = accept(listener, nullptr, nullptr);
+                        if (dropped >= 0) {
+                            ::close(dropped);
+                        }
+                        spareFd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+                        continue;
+                    }
+                    if (errno == EINTR || errno == ECONNABORTED) {
+                        continue;
+                    }
+                    return; // EAGAIN: another loop took it, or the backlog is empty
+                }
+                if (options.unixPath.empty()) {
+                    int on = 1;
+                    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+                }
+
+                std::unique_ptr<Connection> connection(new Connection(fd, seeds.next()));
+                connection->output = connection->session.start();
+                epoll_event event = {};
+                event.events = EPOLLIN;
+                event.data.ptr = connection.get();
+                if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+                    ::close(fd);
+                    continue;
+                }
+                connection->events = EPOLLIN;
+                Connection& added = *connection;
+                connections.emplace(fd, std::move(connection));
+                flush(added);
+            }
+        }
+
+        //--------------------------------------------------------------------------
+        // onReadable
+        // Feeds every complete line to the session and queues the replies.
+        // A client that sends an over-long line, or leaves, is closed; one that
+        // chose Exit is closed once its last reply is out.
+        //--------------------------------------------------------------------------
+        void EventLoop::onReadable(Connection& connection) {
+            char buffer[READ_CHUNK];
+            bool peerClosed = false;
+            while (true) {
+                ssize_t received = recv(connection.fd, buffer, sizeof(buffer), 0);
+                if (received > 0) {
+                    connection.input.append(buffer, static_cast<std::size_t>(received));
+                    if (static_cast<std::size_t>(received) < sizeof(buffer)) {
+                        break;
+                    }
+                    continue;
+                }
+                if (received == 0) {
+                    peerClosed = true;
+                }
+                else if (errno == EINTR) {
+                    continue;
+                }
+                else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    peerClosed = true;
+                }
+                break;
+            }
+
+            std::size_t start = 0;
+            while (!connection.closing) {
+                std::size_t end = connection.input.find('\n', start);
+                if (end == std::string::npos) {
+                    break;
+                }
+                connection.output += connection.session.handleLine(connection.input.substr(start, end - start));
+                start = end + 1;
+                if (connection.session.finished()) {
+                    connection.output += "Goodbye!\n";
+                    connection.closing = true;
+                }
+            }
+            connection.input.erase(0, start);
+            if (connection.input.empty()) {
+                std::string().swap(connection.input); // Idle clients keep no buffer
+            }
+            if (!connection.closing && connection.input.size() > static_cast<std::size_t>(options.maxLineLength)) {
+                connection.output += "\nError: line too long\n";
+                connection.closing = true;
+            }
+
+            flush(connection);
+            if (peerClosed && connection.fd >= 0) {
+                close(connection);
+            }
+        }
+
+        void EventLoop::flush(Connection& connection) {
+            while (connection.sent < connection.output.size()) {
+                ssize_t written = send(connection.fd, connection.output.data() + connection.sent,
+                    connection.output.size() - connection.sent, MSG_NOSIGNAL);
+                if (written > 0) {
+                    connection.sent += static_cast<std::size_t>(written);
+                    continue;
+                }
+                if (written < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    break;
+                }
+                close(connection);
+                return;
+            }
+            if (connection.sent == connection.output.size()) {
+                std::string().swap(connection.output); // A grid reply is kilobytes, do not keep its capacity
+                connection.sent = 0;
+                if (connection.closing) {
+                    close(connection);
+                    return;
+                }
+            }
+            updateInterest(connection);
+        }
+
+        // Reads only while the client keeps up with its replies; waits for
+        // writability only while replies are queued
+        void EventLoop::updateInterest(Connection& connection) {
+            std::size_t pending = connection.output.size() - connection.sent;
+            std::uint32_t wanted = 0;
+            if (!connection.closing && pending < OUTPUT_HIGH_WATER) {
+                wanted |= EPOLLIN;
+            }
+            if (pending > 0) {
+                wanted |= EPOLLOUT;
+            }
+            if (wanted == connection.events) {
+                return;
+            }
+            epoll_event event = {};
+            event.events = wanted;
+            event.data.ptr = &connection;
+            if (epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event) == 0) {
+                connection.events = wanted;
+            }
+        }
+
+        void EventLoop::close(Connection& connection) {
+            int fd = connection.fd;
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+            ::close(fd);
+            connection.fd = -1;
+            auto found = connections.find(fd);
+            if (found != connections.end()) {
+                closed.push_back(std::move(found->second));
+                connections.erase(found);
+            }
+        }
+
+        // Lifts the descriptor limit to the hard limit so one process can hold
+        // tens of thousands of clients
+        void raiseDescriptorLimit() {
+            rlimit limit;
+            if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+                limit.rlim_cur = limit.rlim_max;
+                setrlimit(RLIMIT_NOFILE, &limit);
+            }
+        }
+
+        // Non-blocking listening socket for the options, or -1 with a message
+        int openListener(const ServerOptions& options, std::string& description) {
+            int fd;
+            if (!options.unixPath.empty()) {
+                sockaddr_un address = {};
+                address.sun_family = AF_UNIX;
+                if (options.unixPath.size() >= sizeof(address.sun_path)) {
+                    std::cerr << "Error: socket path too long" << std::endl;
+                    return -1;
+                }
+                std::strcpy(address.sun_path, options.unixPath.c_str());
+                fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                unlink(options.unixPath.c_str());
+                if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                    std::cerr << "Error: cannot bind " << options.unixPath << ": " << std::strerror(errno) << std::endl;
+                    if (fd >= 0) {
+                        ::close(fd);
+                    }
+                    return -1;
+                }
+                description = options.unixPath;
+            }
+            else {
+                sockaddr_in address = {};
+                address.sin_family = AF_INET;
+                address.sin_port = htons(static_cast<std::uint16_t>(options.port));
+                if (inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1) {
+                    std::cerr << "Error: invalid address " << options.host << std::endl;
+                    return -1;
+                }
+                fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                int on = 1;
+                if (fd >= 0) {
+                    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+                }
+                if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                    std::cerr << "Error: cannot bind " << options.host << ":" << options.port << ": " << std::strerror(errno) << std::endl;
+                    if (fd >= 0) {
+                        ::close(fd);
+                    }
+                    return -1;
+                }
+                description = options.host + ":" + std::to_string(options.port);
+            }
+            if (listen(fd, SOMAXCONN) != 0) {
+                std::cerr << "Error: listen: " << std::strerror(errno) << std::endl;
+                ::close(fd);
+                return -1;
+            }
+            return fd;
+        }
+
+    } // namespace
+
+    //------------------------------------------------------------------------------
+    // runServer
+    // Opens the listener, starts one event loop per requested thread (the
+    // calling thread runs the first) and waits for SIGINT or SIGTERM.
+    // SIGUSR1 prints a statistics snapshot to stderr.
+    //------------------------------------------------------------------------------
+    int runServer(const ServerOptions& options) {
+        std::signal(SIGPIPE, SIG_IGN);
+        std::signal(SIGINT, onStopSignal);
+        std::signal(SIGTERM, onStopSignal);
+        std::signal(SIGUSR1, onStatsSignal);
+        raiseDescriptorLimit();
+
+        std::string description;
+        int listener = openListener(options, description);
+        if (listener < 0) {
+            return 1;
+        }
+
+        int loopCount = options.loops > 0 ? options.loops : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        std::uint64_t seed = Random::freshSeed();
+        std::vector<std::unique_ptr<EventLoop>> loops;
+        for (int i = 0; i < loopCount; ++i) {
+            loops.emplace_back(new EventLoop(listener, options, Random::deriveSeed(seed, static_cast<std::uint64_t>(i))));
+            if (!loops.back()->ready()) {
+                std::cerr << "Error: cannot create event loop: " << std::strerror(errno) << std::endl;
+                ::close(listener);
+                return 1;
+            }
+        }
+
+        std::cout << "Serving on " << description << " with " << loopCount << " event loop(s)" << std::endl;
+        std::vector<std::thread> threads;
+        for (int i = 1; i < loopCount; ++i) {
+            threads.emplace_back([&loops, i]() { loops[i]->run(); });
+        }
+        loops[0]->run();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        loops.clear();
+        ::close(listener);
+        if (!options.unixPath.empty()) {
+            unlink(options.unixPath.c_str());
+        }
+        std::cout << "Server stopped" << std::endl;
+        return 0;
+    }
+
+#else
+
+    int runServer(const ServerOptions&) {
+        std::cerr << "Error: the server needs Linux (epoll)" << std::endl;
+        return 1;
+    }
+
+#endif
+
+} // namespace WordGame
@@ -0,0 +1,821 @@
+#include "header.h"
+#include <cstring>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WORDGAME_HAVE_WRITE 1
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+namespace WordGame {
+
+    namespace {
+
+        const int TOP_SCORES_SHOWN = 5; // Entries per board on the high score screen
+        const int GRID_TOP = 4; // Screen row of the grid, under the level banner
+        const int STATUS_ROWS = 10; // Rows kept under the grid for messages and the prompt
+
+        // Rules of a mode, shared by every session. Sessions only use the
+        // const members, so one instance serves all threads.
+        const GameMode& modeRules(int modeSel) {
+            static const EasyMode easy;
+            static const HardMode hard;
+            return modeSel == 1 ? static_cast<const GameMode&>(easy) : static_cast<const GameMode&>(hard);
+        }
+
+        // Sends a reply to stdout in one write; stdio would hand a terminal a
+        // line at a time
+        void writeReply(const std::string& text) {
+            std::cout.flush();
+#ifdef WORDGAME_HAVE_WRITE
+            std::size_t written = 0;
+            while (written < text.size()) {
+                ssize_t count = ::write(STDOUT_FILENO, text.data() + written, text.size() - written);
+                if (count < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return;
+                }
+                written += static_cast<std::size_t>(count);
+            }
+#else
+            std::cout << text << std::flush;
+#endif
+        }
+
+        // Console scores are kept under the OS user, so one person's games
+        // share a place on the boards
+        std::uint64_t consolePlayer() {
+            const char* name = std::getenv("USER");
+            if (name == nullptr) {
+                name = std::getenv("USERNAME");
+            }
+            std::string user = name != nullptr ? name : "player";
+            return Dictionary::hash(user.data(), user.size());
+        }
+
+        //--------------------------------------------------------------------------
+        // Session snapshot layout, in the byte order of the machine that wrote
+        // it:
+        //   SnapshotHeader                  fixed fields, 88 bytes
+        //   uint64_t found[maskWords]       the found-cell mask, as CellMask words
+        //   int32_t wordIds[foundCount]     ids of the words found so far
+        //   grid                            size * size cells in row order, 5
+        //                                   bits each, low bits first; 0-25 are
+        //                                   'a'-'z', EMPTY_CODE is ' '
+        // maskWords follows from gridSize. The checksum is Dictionary::hash of
+        // every byte after it. Word ids belong to the mode's word list, so the
+        // list's size is kept to catch a list that changed in between.
+        //--------------------------------------------------------------------------
+        const char SNAPSHOT_MAGIC[8] = { 'W', 'G', 'S', 'E', 'S', 'S', '\x1a', '\n' };
+        const std::uint32_t SNAPSHOT_VERSION = 1;
+        const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+        const int LETTER_BITS = 5;
+        const int EMPTY_CODE = ALPHABET_SIZE;
+
+        const std::uint8_t HAS_MODE = 1; // A mode is selected
+        const std::uint8_t HAS_DICTIONARY = 2; // The mode's word list is loaded
+
+        struct SnapshotHeader {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t byteOrder; // BYTE_ORDER_MARK as written
+            std::uint64_t checksum;
+            std::uint64_t random[Random::STATE_WORDS];
+            std::uint64_t player;
+            std::int32_t score;
+            std::uint32_t dictionaryWords; // Size of the word list the ids refer to, 0 if none
+            std::uint16_t gridSize; // 0 without a board
+            std::uint8_t state;
+            std::uint8_t modeSel;
+            std::uint8_t flags; // HAS_MODE, HAS_DICTIONARY
+            std::uint8_t reserved;
+            std::int16_t level;
+            std::int16_t chances;
+            std::int16_t wordCount;
+            std::int16_t successfulGuesses;
+            std::int16_t foundCount;
+        };
+
+        static_assert(sizeof(SnapshotHeader) == 88, "SnapshotHeader layout changed");
+
+        const std::size_t CHECKSUMMED_FROM = offsetof(SnapshotHeader, checksum) + sizeof(std::uint64_t);
+
+        std::size_t maskWordsFor(int size) {
+            return (static_cast<std::size_t>(size) * size + 63) / 64;
+        }
+
+        std::size_t packedBytesFor(int size) {
+            return (static_cast<std::size_t>(size) * size * LETTER_BITS + 7) / 8;
+        }
+
+        std::uint64_t letterCode(char ch) {
+            if (ch >= 'a' && ch <= 'z') {
+                return static_cast<std::uint64_t>(ch - 'a');
+            }
+            if (ch == ' ') {
+                return EMPTY_CODE;
+            }
+            throw std::runtime_error("Grid holds a character a snapshot cannot store");
+        }
+
+        //--------------------------------------------------------------------------
+        // packGrid / unpackGrid
+        // Eight cells fill exactly five bytes, so cells go through a 64-bit
+        // register eight at a time; only the last group can be short.
+        //--------------------------------------------------------------------------
+        void packGrid(const CharGrid& grid, char* out) {
+            int size = grid.size();
+            std::uint64_t group = 0;
+            int cellsInGroup = 0;
+            for (int row = 0; row < size; ++row) {
+                const char* letters = grid.rowData(row);
+                for (int col = 0; col < size; ++col) {
+                    group |= letterCode(letters[col]) << (LETTER_BITS * cellsInGroup);
+                    if (++cellsInGroup == 8) {
+                        for (int b = 0; b < LETTER_BITS; ++b) {
+                            *out++ = static_cast<char>(group >> (8 * b));
+                        }
+                        group = 0;
+                        cellsInGroup = 0;
+                    }
+                }
+            }
+            for (int b = 0; b < (cellsInGroup * LETTER_BITS + 7) / 8; ++b) {
+                *out++ = static_cast<char>(group >> (8 * b));
+            }
+        }
+
+        // Returns false on a code that is neither a letter nor EMPTY_CODE
+        bool unpackGrid(const char* in, CharGrid& grid) {
+            int size = grid.size();
+            std::uint64_t group = 0;
+            int cellsLeft = 0;
+            std::size_t cellsTotal = static_cast<std::size_t>(size) * size, cell = 0;
+            for (int row = 0; row < size; ++row) {
+                char* letters = grid.rowData(row);
+                for (int col = 0; col < size; ++col, ++cell) {
+                    if (cellsLeft == 0) {
+                        int bytes = cellsTotal - cell >= 8 ? LETTER_BITS : static_cast<int>(((cellsTotal - cell) * LETTER_BITS + 7) / 8);
+                        group = 0;
+                        for (int b = 0; b < bytes; ++b) {
+                            group |= static_cast<std::uint64_t>(static_cast<unsigned char>(*in++)) << (8 * b);
+                        }
+                        cellsLeft = 8;
+                    }
+                    int code = static_cast<int>(group & ((1u << LETTER_BITS) - 1));
+                    group >>= LETTER_BITS;
+                    --cellsLeft;
+                    if (code > EMPTY_CODE) {
+                        return false;
+                    }
+                    letters[col] = code == EMPTY_CODE ? ' ' : static_cast<char>('a' + code);
+                }
+            }
+            return true;
+        }
+
+    } // namespace
+
+    GameSession::GameSession(std::uint64_t seed, bool console)
+        : random(seed), mode(nullptr), player(console ? consolePlayer() : Random::deriveSeed(seed, 0)), foundCount(0), modeSel(0), level(0), chances(MAX_CHANCES),
+          wordCount(0), successfulGuesses(0), state(State::MainMenu), console(console) {}
+
+    std::string GameSession::start() {
+        std::ostringstream out;
+        showMenu(out);
+        return out.str();
+    }
+
+    //------------------------------------------------------------------------------
+    // handleLine
+    // Dispatches one line of input on the current state. A trailing '\r' is
+    // dropped so telnet-style clients behave like the console.
+    //------------------------------------------------------------------------------
+    std::string GameSession::handleLine(const std::string& line) {
+        std::string input = line;
+        if (!input.empty() && input.back() == '\r') {
+            input.pop_back();
+        }
+
+        std::ostringstream out;
+        switch (state) {
+        case State::MainMenu:
+            onMenu(input, out);
+            break;
+        case State::Paused:
+            showMenu(out);
+            break;
+        case State::SelectMode:
+            onMode(input, out);
+            break;
+        case State::SelectLevel:
+            onLevel(input, out);
+            break;
+        case State::Guessing:
+            onGuess(input, out);
+            break;
+        case State::AskRetry:
+            if (input == "y" || input == "Y") {
+                chances = MAX_CHANCES;
+                foundCount = 0;
+                scoreTracker = ScoreTracker(); // Reset score
+                beginLevel(level, out); // Replay current level
+            }
+            else {
+                endGame(out);
+            }
+            break;
+        case State::AskContinue:
+            if (input == "y" || input == "Y") {
+                beginLevel(level + 1, out);
+            }
+            else {
+                endGame(out);
+            }
+            break;
+        case State::Closed:
+            break;
+        }
+        return out.str();
+    }
+
+    //------------------------------------------------------------------------------
+    // wordListFile
+    // Uses the compiled dictionary (built with tools/DictCompiler) when one sits
+    // next to the text list, since it loads without parsing.
+    //------------------------------------------------------------------------------
+    std::string GameSession::wordListFile(int modeSel) {
+        std::string base = (modeSel == 1) ? "easy_words" : "hard_words";
+        std::ifstream compiled(base + ".wgd", std::ios::binary);
+        return compiled.is_open() ? base + ".wgd" : base + ".txt";
+    }
+
+    void GameSession::clearScreen(std::ostream& out) const {
+        if (console) {
+            out << "\033[2J\033[1;1H";
+        }
+    }
+
+    void GameSession::showMenu(std::ostream& out) {
+        clearScreen(out);
+        out << "========================================================================\n";
+        out << "||                         Word Guessing Game                         ||\n";
+        out << "========================================================================\n";
+        out << "||                             MAIN MENU                              ||\n";
+        out << "========================================================================\n";
+        out << "|| -> Press (a) to Start Game                                         ||\n";
+        out << "|| -> Press (b) to Display Rules and Instructions                     ||\n";
+        out << "|| -> Press (c) for About Us                                          ||\n";
+        out << "|| -> Press (d) to Display Highest Scores                             ||\n";
+        out << "|| -> Press (e) to Exit                                               ||\n";
+        out << "========================================================================\n";
+        out << "Enter your Choice: ";
+        state = State::MainMenu;
+    }
+
+    //------------------------------------------------------------------------------
+    // onMenu
+    // Main menu choice. Rules, credits and scores are shown until the next
+    // line, which brings the menu back.
+    //------------------------------------------------------------------------------
+    void GameSession::onMenu(const std::string& line, std::ostream& out) {
+        if (line.length() != 1 || std::tolower(static_cast<unsigned char>(line[0])) < 'a' || std::tolower(static_cast<unsigned char>(line[0])) > 'e') {
+            out << "Invalid input! Please enter a single character (a-e).\n";
+            out << "Enter your Choice: ";
+            return;
+        }
+
+        char choice = static_cast<char>(std::tolower(static_cast<unsigned char>(line[0])));
+        if (choice == 'a') {
+            clearScreen(out);
+            out << "-------------------------------\n";
+            out << "|       Select Game Mode:     |\n";
+            out << "-------------------------------\n";
+            showModes(out);
+            return;
+        }
+        if (choice == 'e') {
+            state = State::Closed;
+            return;
+        }
+
+        clearScreen(out);
+        if (choice == 'b') {
+            out << "========================================================================\n";
+            out << "||                           INSTRUCTIONS                             ||\n";
+            out << "========================================================================\n";
+            out << "| You have two modes: 'Easy' and 'Hard'. Each mode has 3 levels.       |\n";
+            out << "| In level 1, the grid is 10x10, and you must guess 3 words.           |\n";
+            out << "| In level 2, the grid is 15x15, and you must guess 5 words.           |\n";
+            out << "| In level 3, the grid is 20x20, and you must guess 7 words.           |\n";
+            out << "| In Easy Mode:                                                        |\n";
+            out << "|   - Level 1: Max word length is 2 characters.                        |\n";
+            out << "|   - Level 2: Max word length is 3 characters.                        |\n";
+            out << "|   - Level 3: Max word length is 4 characters.                        |\n";
+            out << "| In Hard Mode:                                                        |\n";
+            out << "|   - Level 1: Max word length is 5 characters.                        |\n";
+            out << "|   - Level 2: Max word length is 6 characters.                        |\n";
+            out << "|   - Level 3: Max word length is 7 characters.                        |\n";
+            out << "| You have " << MAX_CHANCES << " chances to guess the correct word.         |\n";
+            out << "========================================================================\n";
+        }
+        else if (choice == 'c') {
+            out << "========================================================================\n";
+            out << "||                            ABOUT US                                ||\n";
+            out << "========================================================================\n";
+            out << "|| -> This Game is made by Muhammad Abdullah and Hafiz Faheem.        ||\n";
+            out << "|| -> We are students at Fast NUCES CFD campus, studying CS.          ||\n";
+            out << "========================================================================\n";
+        }
+        else {
+            out << "========================================================================\n";
+            out << "||                           HIGHEST SCORE                            ||\n";
+            out << "========================================================================\n";
+            try {
+                ScoreStore& scores = ScoreStore::instance();
+                for (int modeNum = 1; modeNum <= 2; ++modeNum) {
+                    for (int levelNum = 1; levelNum <= 3; ++levelNum) {
+                        out << (modeNum == 1 ? "Easy" : "Hard") << " level " << levelNum << ":";
+                        std::vector<ScoreEntry> best = scores.top(modeNum, levelNum, TOP_SCORES_SHOWN);
+                        for (const ScoreEntry& entry : best) {
+                            out << " " << entry.score;
+                        }
+                        int place = scores.rank(modeNum, levelNum, player);
+                        if (place > 0) {
+                            int players = scores.boardSize(modeNum, levelNum);
+                            out << "   (you: #" << place << " of " << players << ", top " << (100 * place + players - 1) / players << "%)";
+                        }
+                        out << (best.empty() ? " -\n" : "\n");
+                    }
+                }
+            }
+            catch (const std::exception& e) {
+                out << "Error: " << e.what() << "\n";
+            }
+        }
+        out << "Press Enter to return to menu...";
+        state = State::Paused;
+    }
+
+    void GameSession::showModes(std::ostream& out) {
+        out << "| -> Press (1) for Easy Mode  |\n";
+        out << "| -> Press (2) for Hard Mode  |\n";
+        out << "-------------------------------\n";
+        out << "Enter your choice: ";
+        state = State::SelectMode;
+    }
+
+    void GameSession::onMode(const std::string& line, std::ostream& out) {
+        if (line != "1" && line != "2") {
+            out << "Invalid choice! Please enter 1 or 2.\n";
+            showModes(out);
+            return;
+        }
+        modeSel = static_cast<std::int16_t>(std::stoi(line));
+        mode = &modeRules(modeSel);
+        showLevels(out);
+    }
+
+    void GameSession::showLevels(std::ostream& out) {
+        out << "-------------------------------\n";
+        out << "|       Select Level:         |\n";
+        out << "-------------------------------\n";
+        out << "| -> Press (1) for Level 1    |\n";
+        out << "| -> Press (2) for Level 2    |\n";
+        out << "| -> Press (3) for Level 3    |\n";
+        out << "-------------------------------\n";
+        out << "Enter your choice: ";
+        state = State::SelectLevel;
+    }
+
+    void GameSession::onLevel(const std::string& line, std::ostream& out) {
+        if (line != "1" && line != "2" && line != "3") {
+            out << "Invalid choice! Please enter 1, 2, or 3.\n";
+            showLevels(out);
+            return;
+        }
+
+        try {
+            dictionary = DictionaryRegistry::instance().get(wordListFile(modeSel));
+        }
+        catch (const std::exception& e) {
+            out << "Error: " << e.what() << "\n";
+            mode = nullptr;
+            showMenu(out);
+            return;
+        }
+
+        chances = MAX_CHANCES;
+        foundCount = 0;
+        scoreTracker = ScoreTracker();
+        if (console) {
+            prefetcher.reset(new GridPrefetcher(*mode, *dictionary, random.next()));
+        }
+        beginLevel(std::stoi(line), out);
+    }
+
+    //------------------------------------------------------------------------------
+    // beginLevel
+    // Installs the level's grid, from the prefetcher when there is one, and
+    // queues the retry grid and the next level's grid behind it. The puzzle's
+    // index is kept with the grid, so a guess only probes the starts of its
+    // first two letters however large the grid is.
+    //------------------------------------------------------------------------------
+    void GameSession::beginLevel(int levelNum, std::ostream& out) {
+        level = static_cast<std::int16_t>(levelNum);
+        Puzzle puzzle;
+        if (prefetcher) {
+            puzzle = prefetcher->take(level);
+        }
+        else {
+            try {
+                puzzle = mode->makePuzzle(*dictionary, level, random);
+            }
+            catch (const std::exception& e) {
+                out << "Error: " << e.what() << "\n";
+            }
+        }
+        board = std::move(puzzle.grid);
+        boardIndex = std::move(puzzle.index);
+        if (board.empty()) {
+            out << "Failed to initialize grid for level " << level << "\n";
+            endGame(out);
+            return;
+        }
+        foundCells.reset(board.size());
+        if (prefetcher) {
+            prefetcher->prefetch(level);
+            if (level < 3) {
+                prefetcher->prefetch(level + 1);
+            }
+        }
+
+        int screenRows, screenCols;
+        if (console && GridRenderer::terminalSize(screenRows, screenCols)) {
+            if (!screen) {
+                screen.reset(new GridRenderer());
+            }
+            screen->layout(board.size(), GRID_TOP, screenRows, screenCols, STATUS_ROWS);
+        }
+        else {
+            screen.reset();
+        }
+
+        clearScreen(out);
+        out << "============================\n";
+        out << "|          GRID            |\n";
+        out << "============================\n";
+        if (screen) {
+            out << screen->drawFrame(board, &foundCells);
+        }
+        else {
+            GameMode::printGrid(board, foundCells, out);
+        }
+
+        wordCount = static_cast<std::int16_t>(mode->getWordCount(level));
+        const PlacementResult& placement = puzzle.placement;
+        if (placement.placed < placement.requested) {
+            out << "Could not place " << (placement.requested - placement.placed) << " of " << placement.requested << " words.\n";
+            wordCount = static_cast<std::int16_t>(std::max(1, placement.placed));
+        }
+        successfulGuesses = 0;
+
+        out << "You need to guess " << wordCount << " words to complete level " << level << ".\n";
+        out << "Chances remaining: " << chances << "\n\n";
+        if (screen && screen->clipped()) {
+            screen->describeViewport(out);
+        }
+        out << "Enter a word to guess: ";
+        state = State::Guessing;
+    }
+
+    //------------------------------------------------------------------------------
+    // onGuess
+    // Found words are kept as dictionary ids. A word has to be in the
+    // dictionary to be found, so a guess without an id was never found before.
+    // The board is only read; a found word's cells go into foundCells, so a
+    // later word that crosses them still matches. On a terminal the grid stays
+    // where it is: replies replace the text under it, a found word is patched
+    // in, and :w :a :s :d scroll a clipped grid.
+    //------------------------------------------------------------------------------
+    void GameSession::onGuess(const std::string& guess, std::ostream& out) {
+        if (screen) {
+            if (screen->clipped() && guess.size() == 2 && guess[0] == ':') {
+                const std::string directions = "wsad";
+                std::size_t direction = directions.find(guess[1]);
+                if (direction != std::string::npos) {
+                    const int rowSteps[] = { -1, 1, 0, 0 };
+                    const int colSteps[] = { 0, 0, -1, 1 };
+                    if (screen->scroll(rowSteps[direction], colSteps[direction])) {
+                        out << screen->drawFrame(board, &foundCells);
+                    }
+                    out << screen->clearBelow();
+                    screen->describeViewport(out);
+                    out << "Enter a word to guess: ";
+                    return;
+                }
+            }
+            out << screen->clearBelow();
+        }
+
+        WordValidator validator;
+        if (boardIndex.empty()) {
+            boardIndex.build(board); // Restored sessions index on first use
+        }
+        int wordLength = mode->getWordLength(level);
+        int wordId = dictionary->find(guess);
+        if (static_cast<int>(guess.length()) != wordLength) {
+            out << "Word must be exactly " << wordLength << " characters long.\n";
+            --chances;
+            out << "Chances remaining: " << chances << "\n\n";
+        }
+        else if (wordId >= 0 && std::find(found, found + foundCount, wordId) != found + foundCount) {
+            out << "You already guessed this word.\n";
+            --chances;
+            out << "Chances remaining: " << chances << "\n\n";
+        }
+        else if (validator.checkWordInGrid(guess, board, boardIndex, foundCells)) {
+            out << "++++++++++++ Matched ++++++++++++++\n";
+            if (wordId < 0) {
+                out << "Word is in grid but not in dictionary.\n";
+                --chances;
+                out << "Chances remaining: " << chances << "\n\n";
+            }
+            else {
+                out << "Congratulations! You found: " << guess << "\n";
+                if (foundCount < MAX_FOUND_WORDS) {
+                    found[foundCount++] = wordId;
+                }
+                ++successfulGuesses;
+                scoreTracker.updateScore(true);
+                if (screen) {
+                    out << screen->drawChanges(board, &foundCells);
+                }
+                else {
+                    GameMode::printGrid(board, foundCells, out);
+                }
+                out << "Guessed words: " << foundCount << " / " << wordCount << "\n";
+                out << "Chances remaining: " << chances << "\n\n";
+            }
+        }
+        else {
+            out << "Word not found in grid.\n";
+            --chances;
+            scoreTracker.updateScore(false);
+            out << "Guessed words: " << foundCount << " / " << wordCount << "\n";
+            out << "Chances remaining: " << chances << "\n\n";
+        }
+
+        if (chances > 0 && successfulGuesses < wordCount) {
+            out << "Enter a word to guess: ";
+            return;
+        }
+        endLevel(out);
+    }
+
+    void GameSession::endLevel(std::ostream& out) {
+        if (successfulGuesses < wordCount) {
+            out << "Game Over! Final score: " << scoreTracker.getScore() << "\n";
+            out << "Words found: ";
+            for (int i = 0; i < foundCount; ++i) {
+                out << dictionary->word(found[i]) << " ";
+            }
+            out << "\n";
+            out << "Retry level? (y/n): ";
+            state = State::AskRetry;
+            return;
+        }
+
+        out << "Congratulations! You've completed level " << level << "!\n";
+        if (level < 3) {
+            out << "Continue to next level? (y/n): ";
+            state = State::AskContinue;
+            return;
+        }
+        endGame(out);
+    }
+
+    void GameSession::endGame(std::ostream& out) {
+        try {
+            ScoreStore::instance().append(ScoreEntry{ modeSel, level, player, scoreTracker.getScore(), static_cast<std::int64_t>(std::time(nullptr)) });
+        }
+        catch (const std::exception& e) {
+            out << "Error: " << e.what() << "\n";
+        }
+        prefetcher.reset();
+        mode = nullptr;
+        board.release();
+        boardIndex = GridIndex();
+        foundCells.release();
+        dictionary.reset();
+        foundCount = 0;
+        showMenu(out);
+    }
+
+    //------------------------------------------------------------------------------
+    // save
+    // Writes the snapshot straight into out, which a caller can reuse between
+    // sessions so that saving does not allocate. Background threads are not
+    // part of a session's state: a console session's queued grids are simply
+    // built again.
+    //------------------------------------------------------------------------------
+    void GameSession::save(std::string& out) const {
+        SnapshotHeader header = {};
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.version = SNAPSHOT_VERSION;
+        header.byteOrder = BYTE_ORDER_MARK;
+        random.saveState(header.random);
+        header.player = player;
+        header.score = scoreTracker.getScore();
+        header.dictionaryWords = dictionary ? static_cast<std::uint32_t>(dictionary->size()) : 0;
+        header.gridSize = static_cast<std::uint16_t>(board.size());
+        header.state = static_cast<std::uint8_t>(state);
+        header.modeSel = static_cast<std::uint8_t>(modeSel);
+        header.flags = static_cast<std::uint8_t>((mode != nullptr ? HAS_MODE : 0) | (dictionary ? HAS_DICTIONARY : 0));
+        header.level = level;
+        header.chances = chances;
+        header.wordCount = wordCount;
+        header.successfulGuesses = successfulGuesses;
+        header.foundCount = foundCount;
+
+        std::size_t maskBytes = board.empty() ? 0 : foundCells.words() * sizeof(std::uint64_t);
+        std::size_t idBytes = static_cast<std::size_t>(foundCount) * sizeof(std::int32_t);
+        std::size_t start = out.size();
+        out.resize(start + sizeof(header) + maskBytes + idBytes + (board.empty() ? 0 : packedBytesFor(board.size())));
+        char* snapshot = &out[start];
+        char* at = snapshot + sizeof(header);
+        if (maskBytes > 0) {
+            std::memcpy(at, foundCells.data(), maskBytes);
+            at += maskBytes;
+        }
+        std::memcpy(at, found, idBytes);
+        at += idBytes;
+        if (!board.empty()) {
+            packGrid(board, at);
+        }
+        std::memcpy(snapshot, &header, sizeof(header));
+        header.checksum = Dictionary::hash(snapshot + CHECKSUMMED_FROM, out.size() - start - CHECKSUMMED_FROM);
+        std::memcpy(snapshot + offsetof(SnapshotHeader, checksum), &header.checksum, sizeof(header.checksum));
+    }
+
+    //------------------------------------------------------------------------------
+    // restore
+    // Reads the snapshot in place, so it can come from a mapped file without
+    // a copy: fixed fields, mask words and word ids are copied straight into
+    // the session, and only the grid is decoded. The grid's index is not in
+    // the snapshot, being larger than everything else in it; the first guess
+    // after a restore builds it again. Everything is checked before the
+    // session changes, so a rejected snapshot leaves it as it was.
+    //------------------------------------------------------------------------------
+    void GameSession::restore(const char* data, std::size_t size) {
+        SnapshotHeader header;
+        if (size < sizeof(header)) {
+            throw std::runtime_error("Truncated session snapshot");
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || header.version != SNAPSHOT_VERSION ||
+            header.byteOrder != BYTE_ORDER_MARK) {
+            throw std::runtime_error("Unsupported session snapshot version or byte order");
+        }
+
+        int gridSize = header.gridSize;
+        std::size_t maskBytes = gridSize > 0 ? maskWordsFor(gridSize) * sizeof(std::uint64_t) : 0;
+        std::size_t idBytes = header.foundCount >= 0 ? static_cast<std::size_t>(header.foundCount) * sizeof(std::int32_t) : 0;
+        std::size_t gridBytes = gridSize > 0 ? packedBytesFor(gridSize) : 0;
+        if (size != sizeof(header) + maskBytes + idBytes + gridBytes ||
+            header.checksum != Dictionary::hash(data + CHECKSUMMED_FROM, size - CHECKSUMMED_FROM)) {
+            throw std::runtime_error("Corrupt session snapshot");
+        }
+
+        State savedState = static_cast<State>(header.state);
+        bool hasMode = (header.flags & HAS_MODE) != 0;
+        bool hasDictionary = (header.flags & HAS_DICTIONARY) != 0;
+        bool playing = savedState == State::Guessing || savedState == State::AskRetry || savedState == State::AskContinue;
+        bool stateValid = header.state <= static_cast<std::uint8_t>(State::Closed) &&
+            (savedState != State::SelectLevel || hasMode) && (!playing || (hasDictionary && gridSize > 0));
+        bool allZero = std::all_of(header.random, header.random + Random::STATE_WORDS, [](std::uint64_t word) { return word == 0; });
+        if (!stateValid || allZero || header.modeSel > 2 || (hasMode && header.modeSel == 0) || (hasDictionary && !hasMode) ||
+            header.level < 0 || header.level > NUM_LEVELS || (gridSize > 0 && header.level == 0) ||
+            header.foundCount < 0 || header.foundCount > MAX_FOUND_WORDS || header.chances < 0 || header.chances > MAX_CHANCES ||
+            header.successfulGuesses < 0 || header.successfulGuesses > header.wordCount || header.wordCount > MAX_FOUND_WORDS) {
+            throw std::runtime_error("Corrupt session snapshot");
+        }
+        if (playing) {
+            // found[] spans every level since the game or retry started, and the
+            // level's remaining words must still fit in it.
+            const GameMode& rules = modeRules(header.modeSel);
+            int wordsThroughLevel = 0;
+            for (int l = 1; l <= header.level; ++l) {
+                wordsThroughLevel += rules.getWordCount(l);
+            }
+            if (header.wordCount < 1 || header.wordCount > rules.getWordCount(header.level) ||
+                header.successfulGuesses > header.foundCount || header.foundCount > wordsThroughLevel ||
+                header.foundCount - header.successfulGuesses + header.wordCount > MAX_FOUND_WORDS) {
+                throw std::runtime_error("Corrupt session snapshot");
+            }
+        }
+
+        std::shared_ptr<const Dictionary> words;
+        if (hasDictionary) {
+            words = DictionaryRegistry::instance().get(wordListFile(header.modeSel));
+            if (static_cast<std::uint32_t>(words->size()) != header.dictionaryWords) {
+                throw std::runtime_error("Session snapshot was saved with a different word list");
+            }
+        }
+        const char* at = data + sizeof(header);
+        CellMask mask;
+        if (gridSize > 0) {
+            mask.reset(gridSize);
+            std::memcpy(mask.data(), at, maskBytes);
+        }
+        at += maskBytes;
+        std::int32_t ids[MAX_FOUND_WORDS];
+        std::memcpy(ids, at, idBytes);
+        at += idBytes;
+        for (int i = 0; i < header.foundCount; ++i) {
+            if (ids[i] < 0 || static_cast<std::uint32_t>(ids[i]) >= header.dictionaryWords) {
+                throw std::runtime_error("Corrupt session snapshot");
+            }
+        }
+        CharGrid grid;
+        if (gridSize > 0) {
+            grid.reset(gridSize, gridSize >= CACHE_LINE_SIZE);
+            if (!unpackGrid(at, grid)) {
+                throw std::runtime_error("Corrupt session snapshot");
+            }
+        }
+
+        random.restoreState(header.random);
+        player = header.player;
+        scoreTracker = ScoreTracker();
+        scoreTracker.restoreScore(header.score);
+        prefetcher.reset(); // Waits for its workers, which read the old dictionary
+        screen.reset();
+        dictionary = std::move(words);
+        mode = hasMode ? &modeRules(header.modeSel) : nullptr;
+        board = std::move(grid);
+        boardIndex = GridIndex();
+        foundCells = std::move(mask);
+        std::copy(ids, ids + header.foundCount, found);
+        foundCount = header.foundCount;
+        modeSel = header.modeSel;
+        level = header.level;
+        chances = header.chances;
+        wordCount = header.wordCount;
+        successfulGuesses = header.successfulGuesses;
+        state = savedState;
+    }
+
+    //------------------------------------------------------------------------------
+    // resume
+    // What a returning client needs to carry on: the prompt of the state the
+    // session was saved in and, during a level, the grid with its found cells.
+    //------------------------------------------------------------------------------
+    std::string GameSession::resume() {
+        std::ostringstream out;
+        switch (state) {
+        case State::SelectMode:
+            showModes(out);
+            break;
+        case State::SelectLevel:
+            showLevels(out);
+            break;
+        case State::Guessing:
+            clearScreen(out);
+            GameMode::printGrid(board, foundCells, out);
+            out << "Guessed words: " << foundCount << " / " << wordCount << "\n";
+            out << "Chances remaining: " << chances << "\n\n";
+            out << "Enter a word to guess: ";
+            break;
+        case State::AskRetry:
+            out << "Retry level? (y/n): ";
+            break;
+        case State::AskContinue:
+            out << "Continue to next level? (y/n): ";
+            break;
+        case State::Closed:
+            break;
+        default:
+            showMenu(out);
+            break;
+        }
+        return out.str();
+    }
+
+    //------------------------------------------------------------------------------
+    // displayMenu
+    // Feeds stdin to a console session until the player exits or input ends.
+    //------------------------------------------------------------------------------
+    void Game::displayMenu() {
+        GameSession session(Random::freshSeed(), true);
+        writeReply(session.start());
+        std::string line;
+        while (!session.finished() && std::getline(std::cin, line)) {
+            writeReply(session.handleLine(line));
+        }
+    }
+
+} // namespace WordGame
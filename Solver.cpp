@@ -0,0 +1,161 @@
+#include "Solver.h"
+#include <queue>
+
+namespace WordGame {
+
+    namespace {
+
+        const int SOLVE_RUN_CELLS = 1 << 14; // Cells per run of lines in a parallel solve
+
+    } // namespace
+
+    //------------------------------------------------------------------------------
+    // AhoCorasick::build
+    // Inserts every word into a trie, then computes failure links breadth-first
+    // and folds them into a dense goto table. Words are matched case-insensitively;
+    // words containing anything other than letters are skipped.
+    //------------------------------------------------------------------------------
+    void AhoCorasick::build(const Dictionary& words) {
+        int count = words.size();
+        start(count);
+        for (int id = 0; id < count; ++id) {
+            insert(words.word(id), id, false);
+        }
+        link();
+    }
+
+    //------------------------------------------------------------------------------
+    // AhoCorasick::buildLines
+    // Builds over the words of one length and their reversals, so a single
+    // pass along a line finds the words that run either way along it. A
+    // reversal reports the id of its word.
+    //------------------------------------------------------------------------------
+    void AhoCorasick::buildLines(const Dictionary& words, int length) {
+        start(words.size());
+        WordBucket bucket = words.bucket(length);
+        for (int k = 0; k < bucket.count; ++k) {
+            int id = bucket.id(k);
+            insert(words.word(id), id, false);
+            insert(words.word(id), id, true);
+        }
+        link();
+    }
+
+    void AhoCorasick::start(int wordCount) {
+        transitions.assign(ALPHABET_SIZE, -1);
+        outputs.assign(1, -1);
+        outputLinks.assign(1, 0);
+        wordLengths.assign(wordCount, 0);
+        longestWord = 0;
+    }
+
+    void AhoCorasick::insert(std::string_view word, int id, bool backwards) {
+        if (word.empty()) {
+            return;
+        }
+        for (char ch : word) {
+            if (letterIndex(ch) < 0) {
+                return;
+            }
+        }
+
+        int state = 0;
+        int length = static_cast<int>(word.length());
+        for (int k = 0; k < length; ++k) {
+            char ch = word[backwards ? length - 1 - k : k];
+            std::size_t slot = static_cast<std::size_t>(state) * ALPHABET_SIZE + letterIndex(ch);
+            if (transitions[slot] < 0) {
+                transitions[slot] = static_cast<int>(outputs.size());
+                transitions.resize(transitions.size() + ALPHABET_SIZE, -1);
+                outputs.push_back(-1);
+                outputLinks.push_back(0);
+            }
+            state = transitions[slot];
+        }
+        if (outputs[state] < 0) {
+            outputs[state] = id; // Words differing only in case keep the first id
+        }
+        wordLengths[id] = length;
+        longestWord = std::max(longestWord, length);
+    }
+
+    void AhoCorasick::link() {
+        std::vector<int> failure(outputs.size(), 0);
+        std::queue<int> pending;
+        for (int letter = 0; letter < ALPHABET_SIZE; ++letter) {
+            int child = transitions[letter];
+            if (child < 0) {
+                transitions[letter] = 0;
+            }
+            else {
+                pending.push(child);
+            }
+        }
+
+        while (!pending.empty()) {
+            int state = pending.front();
+            pending.pop();
+            int fail = failure[state];
+            outputLinks[state] = outputs[fail] >= 0 ? fail : outputLinks[fail];
+
+            for (int letter = 0; letter < ALPHABET_SIZE; ++letter) {
+                std::size_t slot = static_cast<std::size_t>(state) * ALPHABET_SIZE + letter;
+                int fallback = transitions[static_cast<std::size_t>(fail) * ALPHABET_SIZE + letter];
+                int child = transitions[slot];
+                if (child < 0) {
+                    transitions[slot] = fallback;
+                }
+                else {
+                    failure[child] = fallback;
+                    pending.push(child);
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // GridSolver::solve
+    // Collects every occurrence of every dictionary word in the grid. Grids of
+    // PARALLEL_SEARCH_MIN_CELLS or more are cut into runs of whole lines that
+    // are solved on 'threads' workers (0 means one per core); a line holds
+    // every match it reports, so joining the runs in order gives exactly the
+    // serial result.
+    //------------------------------------------------------------------------------
+    std::vector<WordMatch> GridSolver::solve(const CharGrid& grid, int threads) const {
+        std::vector<WordMatch> matches;
+        int size = grid.size();
+        if (threads <= 0) {
+            threads = hardwareThreads();
+        }
+        if (threads == 1 || static_cast<long long>(size) * size < PARALLEL_SEARCH_MIN_CELLS || automaton.empty()) {
+            forEachMatch(grid, [&](const WordMatch& match) {
+                matches.push_back(match);
+            });
+            return matches;
+        }
+
+        int lines = lineCount(size);
+        int linesPerRun = std::max(1, SOLVE_RUN_CELLS / size);
+        int runs = (lines + linesPerRun - 1) / linesPerRun;
+        std::vector<std::vector<WordMatch>> found(static_cast<std::size_t>(runs));
+        parallelFor(runs, threads, [&](int run) {
+            auto collect = [&](const WordMatch& match) {
+                found[run].push_back(match);
+            };
+            for (int line = run * linesPerRun; line < std::min(lines, (run + 1) * linesPerRun); ++line) {
+                scanLineNumber(grid, line, collect);
+            }
+        });
+
+        std::size_t total = 0;
+        for (const std::vector<WordMatch>& part : found) {
+            total += part.size();
+        }
+        matches.reserve(total);
+        for (const std::vector<WordMatch>& part : found) {
+            matches.insert(matches.end(), part.begin(), part.end());
+        }
+        return matches;
+    }
+
+} // namespace WordGame
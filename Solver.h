@@ -0,0 +1,199 @@
+#pragma once
+#include "header.h"
+
+namespace WordGame {
+
+    //-------------------------------------------------------
+    // AhoCorasick is a dense automaton over a word list.
+    // Every state has a transition for each letter, so the
+    // scan loop is one table lookup per character. Any
+    // non-letter character sends the scan back to the root.
+    //-------------------------------------------------------
+    class AhoCorasick {
+    public:
+        void build(const Dictionary& words); // Builds the automaton over a word list
+        void buildLines(const Dictionary& words, int length); // Words of one length, each also spelled backwards
+        bool empty() const { return wordLengths.empty(); }
+        int stateCount() const { return static_cast<int>(outputs.size()); } // Number of trie states
+        int wordLength(int wordId) const { return wordLengths[wordId]; } // Length of a word by id
+        int maxWordLength() const { return longestWord; } // Longest word in the automaton
+
+        // Advances from 'state' over character 'ch'
+        int next(int state, char ch) const {
+            int letter = letterIndex(ch);
+            return letter < 0 ? 0 : transitions[static_cast<std::size_t>(state) * ALPHABET_SIZE + letter];
+        }
+
+        // True when some word ends in 'state'
+        bool hasOutput(int state) const { return outputs[state] >= 0 || outputLinks[state] > 0; }
+
+        // Calls fn(wordId) for every word that ends in 'state'
+        template <typename Fn>
+        void forEachOutput(int state, Fn&& fn) const {
+            int node = outputs[state] >= 0 ? state : outputLinks[state];
+            while (node > 0) {
+                fn(outputs[node]);
+                node = outputLinks[node];
+            }
+        }
+
+    private:
+        void start(int wordCount); // Resets to a root-only trie
+        void insert(std::string_view word, int id, bool backwards); // Adds a word's path unless it has a non-letter
+        void link(); // Computes failure links and completes the goto table
+
+        std::vector<int> transitions; // stateCount x ALPHABET_SIZE goto table
+        std::vector<int> outputs; // Word id ending at each state, or -1
+        std::vector<int> outputLinks; // Nearest suffix state with an output, or 0
+        std::vector<int> wordLengths; // Length of each word id, 0 if it was skipped
+        int longestWord = 0;
+    };
+
+    //-------------------------------------------------------
+    // GridSolver finds every dictionary word in a grid in a
+    // single pass. Each row, column, diagonal and
+    // anti-diagonal is streamed through the automaton once
+    // forwards and once backwards, which covers all eight
+    // directions. solve() shares the lines of large grids
+    // out between threads.
+    //-------------------------------------------------------
+    class GridSolver {
+    public:
+        explicit GridSolver(const Dictionary& words) { automaton.build(words); }
+        const AhoCorasick& getAutomaton() const { return automaton; }
+
+        std::vector<WordMatch> solve(const CharGrid& grid, int threads = 0) const; // Every occurrence, in forEachMatch order
+
+        // Calls fn(const WordMatch&) for every occurrence in the grid
+        template <typename Fn>
+        void forEachMatch(const CharGrid& grid, Fn&& fn) const;
+
+        // Same for a tiled grid, in grid coordinates; words longer than halo + 1 are not reported
+        template <typename Fn>
+        void forEachMatch(const TiledGrid& grid, Fn&& fn) const;
+
+    private:
+        static int lineCount(int size) { return size > 0 ? 6 * size - 2 : 0; } // Rows, columns, diagonals, anti-diagonals
+        template <typename Fn>
+        void scanLineNumber(const CharGrid& grid, int line, Fn& fn) const; // Scans one line by number
+        template <typename Fn>
+        void scanLine(const CharGrid& grid, int row, int col, int length, int direction, int reverse, Fn& fn) const;
+
+        AhoCorasick automaton;
+    };
+
+    //------------------------------------------------------------------------------
+    // scanLine
+    // Streams the 'length' cells starting at (row, col) in 'direction' through
+    // the automaton, then streams them again from the far end in 'reverse'.
+    // A match ending at position p of the stream starts at p - length + 1,
+    // which is mapped back to a grid cell for the stream's direction.
+    //------------------------------------------------------------------------------
+    template <typename Fn>
+    void GridSolver::scanLine(const CharGrid& grid, int row, int col, int length, int direction, int reverse, Fn& fn) const {
+        int dRow = DIRECTION_ROW[direction], dCol = DIRECTION_COL[direction];
+
+        int state = 0;
+        for (int k = 0; k < length; ++k) {
+            state = automaton.next(state, grid.at(row + k * dRow, col + k * dCol));
+            automaton.forEachOutput(state, [&](int wordId) {
+                int start = k - automaton.wordLength(wordId) + 1;
+                fn(WordMatch{ row + start * dRow, col + start * dCol, direction, wordId });
+            });
+        }
+
+        state = 0;
+        for (int k = length - 1; k >= 0; --k) {
+            state = automaton.next(state, grid.at(row + k * dRow, col + k * dCol));
+            automaton.forEachOutput(state, [&](int wordId) {
+                int wordLen = automaton.wordLength(wordId);
+                if (wordLen == 1) {
+                    return; // Single letters were already reported by the forward pass
+                }
+                int start = k + wordLen - 1;
+                fn(WordMatch{ row + start * dRow, col + start * dCol, reverse, wordId });
+            });
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // scanLineNumber
+    // Lines are numbered in the order forEachMatch visits them: rows, columns,
+    // diagonals from the top row or left column, then anti-diagonals from the
+    // left column or bottom row.
+    //------------------------------------------------------------------------------
+    template <typename Fn>
+    void GridSolver::scanLineNumber(const CharGrid& grid, int line, Fn& fn) const {
+        int size = grid.size();
+
+        // Rows run Right (0) and Left (1)
+        if (line < size) {
+            scanLine(grid, line, 0, size, 0, 1, fn);
+            return;
+        }
+
+        // Only rows report single letters, every other line would repeat them
+        auto multiLetter = [&](const WordMatch& match) {
+            if (automaton.wordLength(match.wordId) > 1) {
+                fn(match);
+            }
+        };
+        line -= size;
+
+        // Columns run Down (2) and Up (3)
+        if (line < size) {
+            scanLine(grid, 0, line, size, 2, 3, multiLetter);
+            return;
+        }
+        line -= size;
+
+        // Diagonals run Down-right (4) and Up-left (7), starting on the top row or left column
+        if (line < 2 * size - 1) {
+            int start = line - (size - 1);
+            int row = start < 0 ? -start : 0;
+            int col = start < 0 ? 0 : start;
+            scanLine(grid, row, col, size - std::max(row, col), 4, 7, multiLetter);
+            return;
+        }
+        line -= 2 * size - 1;
+
+        // Anti-diagonals run Up-right (5) and Down-left (6), starting on the left column or bottom row
+        int row = std::min(line, size - 1);
+        int col = line - row;
+        scanLine(grid, row, col, std::min(row, size - 1 - col) + 1, 5, 6, multiLetter);
+    }
+
+    template <typename Fn>
+    void GridSolver::forEachMatch(const CharGrid& grid, Fn&& fn) const {
+        if (automaton.empty()) {
+            return;
+        }
+        int lines = lineCount(grid.size());
+        for (int line = 0; line < lines; ++line) {
+            scanLineNumber(grid, line, fn);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // forEachMatch (TiledGrid)
+    // Solves each stored tile on its own and keeps the matches that start in
+    // the tile's core. A match starting in the halo belongs to a neighbour,
+    // which reports it in turn.
+    //------------------------------------------------------------------------------
+    template <typename Fn>
+    void GridSolver::forEachMatch(const TiledGrid& grid, Fn&& fn) const {
+        int halo = grid.halo(), core = grid.tileSize();
+        for (int tileRow = 0; tileRow < grid.tilesPerSide(); ++tileRow) {
+            for (int tileCol = 0; tileCol < grid.tilesPerSide(); ++tileCol) {
+                forEachMatch(grid.tile(tileRow, tileCol), [&](const WordMatch& match) {
+                    if (automaton.wordLength(match.wordId) > halo + 1 || match.row < halo || match.row >= halo + core ||
+                        match.col < halo || match.col >= halo + core) {
+                        return;
+                    }
+                    fn(WordMatch{ match.row + grid.tileStart(tileRow), match.col + grid.tileStart(tileCol), match.direction, match.wordId });
+                });
+            }
+        }
+    }
+
+} // namespace WordGame
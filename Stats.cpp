@@ -0,0 +1,357 @@
+#include "Stats.h"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+
+namespace WordGame {
+
+    namespace {
+
+        const char* const METRIC_NAMES[static_cast<int>(Metric::Count)] = {
+            "populateGrid.attempts",
+            "populateGrid.placed",
+            "populateGrid.rejects",
+            "populateGrid.ns",
+            "populateGrid.redraws",
+            "checkWordInGrid.cells",
+            "checkWordInGrid.directions",
+            "dictionary.probes",
+            "loadWords.ns",
+            "render.bytes",
+            "scores.read.ns",
+            "scores.write.ns",
+        };
+
+    } // namespace
+
+    const char* Stats::name(Metric metric) {
+        return METRIC_NAMES[static_cast<int>(metric)];
+    }
+
+    StatsFormat Stats::configuredFormat() {
+        const char* format = std::getenv("WORDGAME_STATS_FORMAT");
+        return format != nullptr && std::string(format) == "json" ? StatsFormat::Json : StatsFormat::Text;
+    }
+
+#ifdef WORDGAME_STATS
+
+    namespace {
+
+        const int NUM_METRICS = static_cast<int>(Metric::Count);
+        const int EXACT_BUCKETS = 16; // Values 0..15 get a bucket each
+        const int SUB_BUCKETS = 8; // Buckets per power of two above that
+        const int NUM_BUCKETS = EXACT_BUCKETS + (64 - 4) * SUB_BUCKETS;
+        const std::size_t MAX_TRACE_EVENTS = 1 << 20; // Per thread, later spans are dropped
+
+        //--------------------------------------------------------------------------
+        // Histogram buckets are log-linear: exact below 16, then eight buckets
+        // per power of two, so a reported percentile is within 1/16 of the
+        // true value whatever the magnitude.
+        //--------------------------------------------------------------------------
+        int bucketOf(std::uint64_t value) {
+            if (value < EXACT_BUCKETS) {
+                return static_cast<int>(value);
+            }
+#if defined(__GNUC__) || defined(__clang__)
+            int exponent = 63 - __builtin_clzll(value);
+#else
+            int exponent = 4;
+            while (exponent < 63 && (value >> (exponent + 1)) != 0) {
+                ++exponent;
+            }
+#endif
+            int sub = static_cast<int>((value >> (exponent - 3)) & (SUB_BUCKETS - 1));
+            return EXACT_BUCKETS + (exponent - 4) * SUB_BUCKETS + sub;
+        }
+
+        // Middle of a bucket's range
+        double bucketValue(int bucket) {
+            if (bucket < EXACT_BUCKETS) {
+                return bucket;
+            }
+            int exponent = 4 + (bucket - EXACT_BUCKETS) / SUB_BUCKETS;
+            int sub = (bucket - EXACT_BUCKETS) % SUB_BUCKETS;
+            double width = std::ldexp(1.0, exponent - 3);
+            return (SUB_BUCKETS + sub) * width + width / 2;
+        }
+
+        const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now(); // Trace timestamps count from here
+
+        struct TraceEvent {
+            Metric metric;
+            double startMicros; // Since traceEpoch
+            double durationMicros;
+        };
+
+        // One thread's samples. Only the owning thread writes; snapshots read
+        // the cells concurrently, hence relaxed atomics rather than locks.
+        struct ThreadBlock {
+            struct Cells {
+                std::atomic<std::uint64_t> count;
+                std::atomic<std::uint64_t> sum;
+                std::atomic<std::uint64_t> max;
+                std::atomic<std::uint64_t> buckets[NUM_BUCKETS];
+            };
+            Cells metrics[NUM_METRICS];
+            int thread; // Number in registration order, the trace's tid
+            std::mutex traceLock; // Owner appends, the exit dump reads
+            std::vector<TraceEvent> trace;
+        };
+
+        // Merged samples of one metric
+        struct Totals {
+            std::uint64_t count = 0;
+            std::uint64_t sum = 0;
+            std::uint64_t max = 0;
+            std::vector<std::uint64_t> buckets = std::vector<std::uint64_t>(NUM_BUCKETS, 0);
+
+            void add(const ThreadBlock::Cells& cells) {
+                count += cells.count.load(std::memory_order_relaxed);
+                sum += cells.sum.load(std::memory_order_relaxed);
+                max = std::max(max, cells.max.load(std::memory_order_relaxed));
+                for (int b = 0; b < NUM_BUCKETS; ++b) {
+                    buckets[b] += cells.buckets[b].load(std::memory_order_relaxed);
+                }
+            }
+
+            // Value at quantile q, capped by the largest sample
+            double quantile(double q) const {
+                if (count == 0) {
+                    return 0.0;
+                }
+                std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(q * count)));
+                std::uint64_t seen = 0;
+                for (int b = 0; b < NUM_BUCKETS; ++b) {
+                    seen += buckets[b];
+                    if (seen >= rank) {
+                        return std::min(bucketValue(b), static_cast<double>(max));
+                    }
+                }
+                return static_cast<double>(max);
+            }
+        };
+
+        void writeAtExit();
+
+        //--------------------------------------------------------------------------
+        // Registry
+        // Tracks the blocks of live threads and keeps what exited threads
+        // recorded. It is created on the first sample and never destroyed, so
+        // threads that outlive main() can still retire into it.
+        //--------------------------------------------------------------------------
+        struct Registry {
+            Registry() {
+                const char* path = std::getenv("WORDGAME_TRACE");
+                if (path != nullptr && *path != '\0') {
+                    tracePath = path;
+                }
+                std::atexit(writeAtExit);
+            }
+
+            std::mutex lock; // Guards everything below
+            std::vector<ThreadBlock*> live;
+            std::vector<Totals> retired = std::vector<Totals>(NUM_METRICS);
+            std::vector<std::pair<int, TraceEvent>> retiredTrace; // Thread number and event
+            int threadsSeen = 0;
+            std::string tracePath; // Empty unless tracing
+        };
+
+        Registry& registry() {
+            static Registry* instance = new Registry();
+            return *instance;
+        }
+
+        ThreadBlock* registerThread() {
+            Registry& stats = registry();
+            ThreadBlock* block = new ThreadBlock(); // Value-initialized, so every cell starts at zero
+            std::lock_guard<std::mutex> guard(stats.lock);
+            block->thread = stats.threadsSeen++;
+            stats.live.push_back(block);
+            return block;
+        }
+
+        // Folds an exiting thread's block into the registry's totals
+        void retireThread(ThreadBlock* block) {
+            Registry& stats = registry();
+            std::lock_guard<std::mutex> guard(stats.lock);
+            for (int m = 0; m < NUM_METRICS; ++m) {
+                stats.retired[m].add(block->metrics[m]);
+            }
+            {
+                std::lock_guard<std::mutex> traceGuard(block->traceLock);
+                for (const TraceEvent& event : block->trace) {
+                    stats.retiredTrace.emplace_back(block->thread, event);
+                }
+            }
+            stats.live.erase(std::find(stats.live.begin(), stats.live.end(), block));
+            delete block;
+        }
+
+        struct LocalBlock {
+            ThreadBlock* block = nullptr;
+            ~LocalBlock() {
+                if (block != nullptr) {
+                    retireThread(block);
+                }
+            }
+        };
+
+        thread_local LocalBlock local;
+
+        ThreadBlock& localBlock() {
+            if (local.block == nullptr) {
+                local.block = registerThread();
+            }
+            return *local.block;
+        }
+
+        // Single writer, so a relaxed load and store is enough
+        void bump(std::atomic<std::uint64_t>& cell, std::uint64_t value) {
+            cell.store(cell.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        //--------------------------------------------------------------------------
+        // writeTrace
+        // Chrome trace-event JSON: one complete ("X") event per timed scope,
+        // with the thread's registration number as its tid.
+        //--------------------------------------------------------------------------
+        void writeTrace(Registry& stats) {
+            std::vector<std::pair<int, TraceEvent>> events = stats.retiredTrace;
+            for (ThreadBlock* block : stats.live) {
+                std::lock_guard<std::mutex> traceGuard(block->traceLock);
+                for (const TraceEvent& event : block->trace) {
+                    events.emplace_back(block->thread, event);
+                }
+            }
+            std::ofstream out(stats.tracePath);
+            if (!out.is_open()) {
+                std::cerr << "Error: cannot write trace " << stats.tracePath << std::endl;
+                return;
+            }
+            out << "{\"traceEvents\": [\n";
+            char line[256];
+            for (std::size_t i = 0; i < events.size(); ++i) {
+                const TraceEvent& event = events[i].second;
+                std::snprintf(line, sizeof(line), "  {\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}%s\n",
+                    Stats::name(event.metric), events[i].first, event.startMicros, event.durationMicros, i + 1 < events.size() ? "," : "");
+                out << line;
+            }
+            out << "]}\n";
+        }
+
+        void writeAtExit() {
+            std::string text = Stats::snapshot(Stats::configuredFormat());
+            const char* path = std::getenv("WORDGAME_STATS_OUT");
+            if (path != nullptr && *path != '\0' && std::string(path) != "-") {
+                std::ofstream out(path);
+                out << text;
+            }
+            else {
+                std::cerr << text;
+            }
+
+            Registry& stats = registry();
+            std::lock_guard<std::mutex> guard(stats.lock);
+            if (!stats.tracePath.empty()) {
+                writeTrace(stats);
+            }
+        }
+
+    } // namespace
+
+    void Stats::record(Metric metric, std::uint64_t value) {
+        ThreadBlock::Cells& cells = localBlock().metrics[static_cast<int>(metric)];
+        bump(cells.count, 1);
+        bump(cells.sum, value);
+        bump(cells.buckets[bucketOf(value)], 1);
+        if (value > cells.max.load(std::memory_order_relaxed)) {
+            cells.max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // recordSpan
+    // Records a duration in nanoseconds and, when tracing, keeps the span.
+    // The trace lock is only ever contended by the exit dump.
+    //------------------------------------------------------------------------------
+    void Stats::recordSpan(Metric metric, std::chrono::steady_clock::time_point started) {
+        auto finished = std::chrono::steady_clock::now();
+        record(metric, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(finished - started).count()));
+
+        Registry& stats = registry();
+        if (stats.tracePath.empty()) {
+            return;
+        }
+        ThreadBlock& block = localBlock();
+        std::lock_guard<std::mutex> guard(block.traceLock);
+        if (block.trace.size() < MAX_TRACE_EVENTS) {
+            block.trace.push_back(TraceEvent{ metric,
+                std::chrono::duration<double, std::micro>(started - traceEpoch).count(),
+                std::chrono::duration<double, std::micro>(finished - started).count() });
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // snapshot
+    // Merges exited threads' totals with every live block. Live blocks are
+    // read while their owners keep recording, so a snapshot taken under load
+    // is consistent per cell, not across cells.
+    //------------------------------------------------------------------------------
+    std::string Stats::snapshot(StatsFormat format) {
+        Registry& stats = registry();
+        std::vector<Totals> totals;
+        int threads;
+        {
+            std::lock_guard<std::mutex> guard(stats.lock);
+            totals = stats.retired;
+            for (ThreadBlock* block : stats.live) {
+                for (int m = 0; m < NUM_METRICS; ++m) {
+                    totals[m].add(block->metrics[m]);
+                }
+            }
+            threads = stats.threadsSeen;
+        }
+
+        std::string out;
+        char line[256];
+        if (format == StatsFormat::Json) {
+            std::snprintf(line, sizeof(line), "{\n  \"threads\": %d,\n  \"metrics\": [\n", threads);
+            out += line;
+            for (int m = 0; m < NUM_METRICS; ++m) {
+                const Totals& t = totals[m];
+                std::snprintf(line, sizeof(line),
+                    "    {\"name\": \"%s\", \"count\": %llu, \"sum\": %llu, \"p50\": %.0f, \"p99\": %.0f, \"max\": %llu}%s\n",
+                    name(static_cast<Metric>(m)), static_cast<unsigned long long>(t.count), static_cast<unsigned long long>(t.sum),
+                    t.quantile(0.50), t.quantile(0.99), static_cast<unsigned long long>(t.max), m + 1 < NUM_METRICS ? "," : "");
+                out += line;
+            }
+            out += "  ]\n}\n";
+            return out;
+        }
+
+        std::snprintf(line, sizeof(line), "Statistics from %d thread(s)\n%-28s %12s %16s %12s %12s %12s\n",
+            threads, "metric", "count", "sum", "p50", "p99", "max");
+        out += line;
+        for (int m = 0; m < NUM_METRICS; ++m) {
+            const Totals& t = totals[m];
+            std::snprintf(line, sizeof(line), "%-28s %12llu %16llu %12.0f %12.0f %12llu\n",
+                name(static_cast<Metric>(m)), static_cast<unsigned long long>(t.count), static_cast<unsigned long long>(t.sum),
+                t.quantile(0.50), t.quantile(0.99), static_cast<unsigned long long>(t.max));
+            out += line;
+        }
+        return out;
+    }
+
+#else
+
+    void Stats::record(Metric, std::uint64_t) {}
+
+    void Stats::recordSpan(Metric, std::chrono::steady_clock::time_point) {}
+
+    std::string Stats::snapshot(StatsFormat format) {
+        return format == StatsFormat::Json ? "{\"enabled\": false}\n" : "Statistics are not compiled in (build with -DWORDGAME_STATS)\n";
+    }
+
+#endif
+
+} // namespace WordGame
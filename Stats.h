@@ -0,0 +1,81 @@
+#pragma once
+#include "header.h"
+
+//-------------------------------------------------------
+// Hot-path instrumentation. Built with -DWORDGAME_STATS
+// the macros below record into per-thread histograms;
+// without it they expand to nothing and cost nothing.
+//
+//   WORDGAME_RECORD(metric, value)  one sample of a metric
+//   WORDGAME_TIME(metric)           times the enclosing scope
+//
+// At exit the merged histograms are written to stderr,
+// as text or as JSON when WORDGAME_STATS_FORMAT=json
+// (WORDGAME_STATS_OUT=<path> writes them to a file).
+// WORDGAME_TRACE=<path> also records every timed scope
+// as a Chrome trace event (chrome://tracing, Perfetto).
+//-------------------------------------------------------
+
+namespace WordGame {
+
+    //-------------------------------------------------------
+    // Metric names one recorded quantity. Each sample goes
+    // into a histogram, so every metric reports how often
+    // it was recorded, its total and its p50/p99/max.
+    //-------------------------------------------------------
+    enum class Metric : int {
+        PlacementAttempts, // Placement tries per populateGrid
+        PlacementsMade, // Words placed per populateGrid
+        PlacementRejects, // Tries that did not place a word, per populateGrid
+        PopulateGridTime, // Nanoseconds per populateGrid
+        FillRedraws, // Background letters drawn again because they spelled a word, per populateGrid
+        SearchCellsProbed, // Grid cells compared per checkWordInGrid
+        SearchDirectionsProbed, // (cell, direction) starts tried per checkWordInGrid
+        DictionaryProbes, // Hash slots probed per dictionary lookup
+        LoadWordsTime, // Nanoseconds per word file load
+        RenderBytes, // Bytes per printed grid, frame or patch
+        ScoreReadTime, // Nanoseconds per score file replayed at startup
+        ScoreWriteTime, // Nanoseconds per score log batch, write and sync
+        Count
+    };
+
+    enum class StatsFormat { Text, Json };
+
+    //-------------------------------------------------------
+    // Stats owns the recorded samples. Each thread records
+    // into its own block without locking; a snapshot merges
+    // every live block with those of threads that exited.
+    //-------------------------------------------------------
+    class Stats {
+    public:
+        static void record(Metric metric, std::uint64_t value); // Adds one sample on the calling thread
+        static void recordSpan(Metric metric, std::chrono::steady_clock::time_point started); // Duration sample, traced if enabled
+        static std::string snapshot(StatsFormat format); // Merged view of every thread so far
+        static StatsFormat configuredFormat(); // WORDGAME_STATS_FORMAT, text by default
+        static const char* name(Metric metric);
+    };
+
+    // Records the time from construction to the end of the scope
+    class StatsTimer {
+    public:
+        explicit StatsTimer(Metric metric) : metric(metric), started(std::chrono::steady_clock::now()) {}
+        ~StatsTimer() { Stats::recordSpan(metric, started); }
+        StatsTimer(const StatsTimer&) = delete;
+        StatsTimer& operator=(const StatsTimer&) = delete;
+
+    private:
+        Metric metric;
+        std::chrono::steady_clock::time_point started;
+    };
+
+} // namespace WordGame
+
+#ifdef WORDGAME_STATS
+#define WORDGAME_STATS_JOIN2(a, b) a##b
+#define WORDGAME_STATS_JOIN(a, b) WORDGAME_STATS_JOIN2(a, b)
+#define WORDGAME_RECORD(metric, value) ::WordGame::Stats::record(::WordGame::Metric::metric, static_cast<std::uint64_t>(value))
+#define WORDGAME_TIME(metric) ::WordGame::StatsTimer WORDGAME_STATS_JOIN(statsTimer, __LINE__)(::WordGame::Metric::metric)
+#else
+#define WORDGAME_RECORD(metric, value) ((void)sizeof(value))
+#define WORDGAME_TIME(metric) ((void)0)
+#endif
@@ -0,0 +1,315 @@
+#include "header.h"
+#include "Kernels.h"
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WORDGAME_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace WordGame {
+
+    namespace {
+
+        enum TileState { TILE_ABSENT, TILE_GENERATING, TILE_READY };
+
+        const int NUM_COLOURS = 4; // Row parity x column parity
+        const std::size_t PAGE_BYTES = 4096; // Tiles start on a page so each maps its own pages
+
+        // Background letter of a cell, the same whichever tile's halo asks for it
+        char backgroundLetter(std::uint64_t seed, int size, int row, int col) {
+            std::uint64_t bits = Random::deriveSeed(seed, static_cast<std::uint64_t>(row) * static_cast<std::uint64_t>(size) + col);
+            return static_cast<char>('a' + (((bits >> 32) * ALPHABET_SIZE) >> 32));
+        }
+
+    } // namespace
+
+    //------------------------------------------------------------------------------
+    // TiledGrid
+    // Sizes the tiles, creates the scratch file and maps it shared, so the
+    // kernel can write cold tiles back to the file instead of keeping the
+    // whole grid in memory. The file is sparse until tiles are generated.
+    //------------------------------------------------------------------------------
+    TiledGrid::TiledGrid(const std::string& path, std::shared_ptr<const Dictionary> words, const Settings& settings)
+        : words(std::move(words)), gridSize(settings.size), coreSize(settings.tileSize),
+        haloSize(settings.halo > 0 ? settings.halo : std::max(settings.wordLength - 1, 1)), storedSize(0), tileCount(0),
+        wordLength(settings.wordLength), wordsPerTile(settings.wordsPerTile), seed(settings.seed), path(path) {
+        if (gridSize <= 0 || coreSize <= 0) {
+            throw std::invalid_argument("Grid and tile sizes must be positive");
+        }
+        if (coreSize <= 2 * haloSize) {
+            throw std::invalid_argument("Tiles must be larger than twice the halo");
+        }
+        if (wordLength > haloSize + 1) {
+            throw std::invalid_argument("Placed words must be at most halo + 1 letters long");
+        }
+        storedSize = coreSize + 2 * haloSize;
+        tileCount = (gridSize + coreSize - 1) / coreSize;
+        std::size_t tiles = static_cast<std::size_t>(tileCount) * tileCount;
+        tileBytes = (static_cast<std::size_t>(storedSize) * storedSize + PAGE_BYTES - 1) / PAGE_BYTES * PAGE_BYTES;
+        mappedBytes = tiles * tileBytes;
+
+#ifdef WORDGAME_HAVE_MMAP
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0) {
+            throw std::runtime_error("Could not create tile file " + path);
+        }
+        if (ftruncate(fd, static_cast<off_t>(mappedBytes)) != 0) {
+            ::close(fd);
+            std::remove(path.c_str());
+            throw std::runtime_error("Could not size tile file " + path);
+        }
+        void* address = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (address == MAP_FAILED) {
+            std::remove(path.c_str());
+            throw std::runtime_error("Could not map tile file " + path);
+        }
+        cells = static_cast<char*>(address);
+#else
+        buffer.assign(mappedBytes, ' ');
+        cells = buffer.data();
+#endif
+
+        views.reserve(tiles);
+        for (std::size_t k = 0; k < tiles; ++k) {
+            views.push_back(CharGrid::view(cells + k * tileBytes, storedSize, static_cast<std::size_t>(storedSize)));
+        }
+        states.reset(new std::atomic<int>[tiles]);
+        for (std::size_t k = 0; k < tiles; ++k) {
+            states[k].store(TILE_ABSENT, std::memory_order_relaxed);
+        }
+        covered.assign(tiles, 0);
+    }
+
+    TiledGrid::~TiledGrid() {
+        views.clear();
+#ifdef WORDGAME_HAVE_MMAP
+        munmap(cells, mappedBytes);
+        std::remove(path.c_str());
+#endif
+    }
+
+    char TiledGrid::at(int row, int col) const {
+        int tileRow = row / coreSize, tileCol = col / coreSize;
+        return tile(tileRow, tileCol).at(row - tileStart(tileRow), col - tileStart(tileCol));
+    }
+
+    //------------------------------------------------------------------------------
+    // tile
+    // The first caller generates the tile; callers that arrive meanwhile wait
+    // for it. A tile whose generation throws goes back to absent.
+    //------------------------------------------------------------------------------
+    const CharGrid& TiledGrid::tile(int tileRow, int tileCol) const {
+        int index = tileIndex(tileRow, tileCol);
+        std::atomic<int>& state = states[index];
+        if (state.load(std::memory_order_acquire) != TILE_READY) {
+            int expected = TILE_ABSENT;
+            if (state.compare_exchange_strong(expected, TILE_GENERATING, std::memory_order_acq_rel)) {
+                try {
+                    generate(tileRow, tileCol);
+                }
+                catch (...) {
+                    state.store(TILE_ABSENT, std::memory_order_release);
+                    throw;
+                }
+                state.store(TILE_READY, std::memory_order_release);
+            }
+            else {
+                while (state.load(std::memory_order_acquire) != TILE_READY) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        return views[index];
+    }
+
+    //------------------------------------------------------------------------------
+    // window
+    // Copies a square region cell by cell, so it may span tiles. Used to show
+    // part of the grid with the usual printers and renderers.
+    //------------------------------------------------------------------------------
+    CharGrid TiledGrid::window(int row, int col, int size) const {
+        CharGrid region(size);
+        for (int i = 0; i < size; ++i) {
+            char* line = region.rowData(i);
+            for (int j = 0; j < size; ++j) {
+                line[j] = inBounds(row + i, col + j) ? at(row + i, col + j) : ' ';
+            }
+        }
+        return region;
+    }
+
+    //------------------------------------------------------------------------------
+    // find
+    // Scans each tile's core cells as word starts with the search kernels;
+    // the halo holds the rest of any word that starts there. Words longer
+    // than the halo allows cannot be found.
+    //------------------------------------------------------------------------------
+    bool TiledGrid::find(std::string_view word, WordMatch& match) const {
+        int length = static_cast<int>(word.length());
+        if (length == 0 || length > haloSize + 1 || length > gridSize) {
+            return false;
+        }
+        std::string lowered(word);
+        for (char& ch : lowered) {
+            ch = lowercase(ch);
+        }
+
+        std::uint64_t probes = 0;
+        for (int tileRow = 0; tileRow < tileCount; ++tileRow) {
+            for (int tileCol = 0; tileCol < tileCount; ++tileCol) {
+                CellRange starts = { haloSize, haloSize + std::min(coreSize, gridSize - tileRow * coreSize),
+                    haloSize, haloSize + std::min(coreSize, gridSize - tileCol * coreSize) };
+                WordMatch found;
+                if (scanGrid(lowered.data(), length, tile(tileRow, tileCol), starts, found, probes)) {
+                    match = WordMatch{ found.row + tileStart(tileRow), found.col + tileStart(tileCol), found.direction, -1 };
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    //------------------------------------------------------------------------------
+    // generateAll
+    // Generates every tile on 'threads' workers. The tiles are independent,
+    // so the result does not depend on the thread count.
+    //------------------------------------------------------------------------------
+    PlacementResult TiledGrid::generateAll(int threads) {
+        auto started = std::chrono::steady_clock::now();
+        parallelFor(tileCount * tileCount, threads, [&](int index) {
+            tile(index / tileCount, index % tileCount);
+        });
+
+        PlacementResult result = { 0, 0, 0, 0, 0.0, 0.0 };
+        long long coveredCells = 0;
+        for (int tileRow = 0; tileRow < tileCount; ++tileRow) {
+            for (int tileCol = 0; tileCol < tileCount; ++tileCol) {
+                std::shared_ptr<const Plan> tilePlan = plan(tileRow, tileCol);
+                result.placed += static_cast<int>(tilePlan->words.size());
+                result.requested += wordsPerTile;
+                result.attempts += tilePlan->attempts;
+                coveredCells += covered[tileIndex(tileRow, tileCol)];
+            }
+        }
+        result.density = static_cast<double>(coveredCells) / (static_cast<double>(gridSize) * gridSize);
+        result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        return result;
+    }
+
+    //------------------------------------------------------------------------------
+    // plan
+    // Plans are small and are needed by up to nine tiles, so they are kept.
+    // Two threads may make the same plan at once; both get the same words.
+    //------------------------------------------------------------------------------
+    std::shared_ptr<const TiledGrid::Plan> TiledGrid::plan(int tileRow, int tileCol) const {
+        int index = tileIndex(tileRow, tileCol);
+        {
+            std::lock_guard<std::mutex> guard(plansLock);
+            auto found = plans.find(index);
+            if (found != plans.end()) {
+                return found->second;
+            }
+        }
+        auto made = std::make_shared<const Plan>(makePlan(tileRow, tileCol));
+        std::lock_guard<std::mutex> guard(plansLock);
+        return plans.emplace(index, std::move(made)).first->second;
+    }
+
+    //------------------------------------------------------------------------------
+    // makePlan
+    // Draws the words of the lower-coloured neighbours into a tile-shaped
+    // scratch grid, then tries random starts in the core with the placement
+    // kernels. Same-coloured tiles are two tiles apart, further than a word
+    // can reach, so no plan has to wait for one of its own colour.
+    //------------------------------------------------------------------------------
+    TiledGrid::Plan TiledGrid::makePlan(int tileRow, int tileCol) const {
+        Plan result;
+        WordBucket candidates = words->bucket(wordLength);
+        if (candidates.count == 0 || wordsPerTile <= 0 || wordLength < 1 || wordLength > gridSize) {
+            return result;
+        }
+
+        CharGrid scratch(storedSize);
+        scratch.fill(' ');
+        drawPlans(scratch, tileRow, tileCol, colour(tileRow, tileCol));
+
+        const std::array<PlaceKernel, NUM_DIRECTIONS>& place = placeKernels(wordLength);
+        Random random(Random::deriveSeed(seed, static_cast<std::uint64_t>(tileIndex(tileRow, tileCol))));
+        int firstRow = tileRow * coreSize, rows = std::min(coreSize, gridSize - firstRow);
+        int firstCol = tileCol * coreSize, cols = std::min(coreSize, gridSize - firstCol);
+        const int maxAttempts = 100 * wordsPerTile;
+
+        while (static_cast<int>(result.words.size()) < wordsPerTile && result.attempts < maxAttempts) {
+            ++result.attempts;
+            int wordId = candidates.id(random.below(candidates.count));
+            int direction = random.below(NUM_DIRECTIONS);
+            int row = firstRow + random.below(rows);
+            int col = firstCol + random.below(cols);
+            if (!inBounds(row + (wordLength - 1) * DIRECTION_ROW[direction], col + (wordLength - 1) * DIRECTION_COL[direction])) {
+                continue;
+            }
+            if (place[direction](words->word(wordId), scratch, row - tileStart(tileRow), col - tileStart(tileCol))) {
+                result.words.push_back(PlannedWord{ row, col, direction, wordId });
+            }
+        }
+        return result;
+    }
+
+    // Writes the words planned by this tile and its neighbours whose colour is below 'belowColour'
+    void TiledGrid::drawPlans(CharGrid& view, int tileRow, int tileCol, int belowColour) const {
+        int originRow = tileStart(tileRow), originCol = tileStart(tileCol);
+        for (int nearRow = std::max(tileRow - 1, 0); nearRow <= std::min(tileRow + 1, tileCount - 1); ++nearRow) {
+            for (int nearCol = std::max(tileCol - 1, 0); nearCol <= std::min(tileCol + 1, tileCount - 1); ++nearCol) {
+                if (colour(nearRow, nearCol) >= belowColour) {
+                    continue;
+                }
+                for (const PlannedWord& planned : plan(nearRow, nearCol)->words) {
+                    std::string_view text = words->word(planned.wordId);
+                    for (int k = 0; k < static_cast<int>(text.length()); ++k) {
+                        int row = planned.row + k * DIRECTION_ROW[planned.direction] - originRow;
+                        int col = planned.col + k * DIRECTION_COL[planned.direction] - originCol;
+                        if (row >= 0 && row < storedSize && col >= 0 && col < storedSize) {
+                            view.set(row, col, text[k]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // generate
+    // Writes the words of every plan that reaches the stored tile, then gives
+    // each other cell inside the grid its background letter. Cells of the
+    // halo that fall outside the grid stay ' ', which matches no word.
+    //------------------------------------------------------------------------------
+    void TiledGrid::generate(int tileRow, int tileCol) const {
+        int index = tileIndex(tileRow, tileCol);
+        CharGrid& view = views[index];
+        view.fill(' ');
+        drawPlans(view, tileRow, tileCol, NUM_COLOURS);
+
+        int originRow = tileStart(tileRow), originCol = tileStart(tileCol);
+        int coveredCells = 0;
+        for (int i = 0; i < storedSize; ++i) {
+            char* line = view.rowData(i);
+            int row = originRow + i;
+            bool coreRow = i >= haloSize && i < haloSize + coreSize;
+            for (int j = 0; j < storedSize; ++j) {
+                int col = originCol + j;
+                if (line[j] != ' ') {
+                    coveredCells += coreRow && j >= haloSize && j < haloSize + coreSize;
+                }
+                else if (inBounds(row, col)) {
+                    line[j] = backgroundLetter(seed, gridSize, row, col);
+                }
+            }
+        }
+        covered[index] = coveredCells;
+    }
+
+} // namespace WordGame
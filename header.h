@@ -1,38 +1,586 @@
 #pragma once
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <chrono>
 #include <thread>
 #include <ctime>
 #include <cstdlib>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 namespace WordGame {
 
-    const int MAX_WORDS = 100; // Maximum number of words
     const int MAX_WORD_LENGTH = 50; // Maximum length of each word
     const int MAX_CHANCES = 5; // Maximum chances per game
-    const int GRID_SIZES[] = { 10, 15, 20 }; // Grid sizes for levels 1, 2, 3
-    const int NUM_DIRECTIONS = 8; // Number of search directions
+    constexpr int NUM_LEVELS = 3; // Levels per mode
+    constexpr int GRID_SIZES[NUM_LEVELS] = { 10, 15, 20 }; // Grid sizes for levels 1, 2, 3
+    constexpr int LEVEL_WORD_COUNTS[NUM_LEVELS] = { 3, 5, 7 }; // Words to find per level, both modes
+    constexpr int EASY_WORD_LENGTHS[NUM_LEVELS] = { 2, 3, 4 }; // Word length per level in easy mode
+    constexpr int HARD_WORD_LENGTHS[NUM_LEVELS] = { 5, 6, 7 }; // Word length per level in hard mode
+    constexpr int NUM_DIRECTIONS = 8; // Number of search directions
+    const int CACHE_LINE_SIZE = 64; // Row stride alignment for padded grids
+    const int PARALLEL_SEARCH_MIN_CELLS = 256 * 256; // Smaller grids are scanned and solved on one thread
+    constexpr int DIRECTION_ROW[NUM_DIRECTIONS] = { 0, 0, 1, -1, 1, -1, 1, -1 }; // Row step: Right, Left, Down, Up, Down-right, Up-right, Down-left, Up-left
+    constexpr int DIRECTION_COL[NUM_DIRECTIONS] = { 1, -1, 0, 0, 1, 1, -1, -1 }; // Column step for the same directions
 
+    const int ALPHABET_SIZE = 26; // Letters a-z
+
+    // Maps a letter to 0..25 regardless of case, anything else to -1
+    inline int letterIndex(char ch) {
+        if (ch >= 'a' && ch <= 'z') return ch - 'a';
+        if (ch >= 'A' && ch <= 'Z') return ch - 'A';
+        return -1;
+    }
+
+    //-------------------------------------------------------
+    // WordMatch records one occurrence of a word in the
+    // grid: its first cell, the direction it runs in and
+    // the index of the word in the list that was searched.
+    //-------------------------------------------------------
+    struct WordMatch {
+        int row; // Row of the first letter
+        int col; // Column of the first letter
+        int direction; // 0..7, same numbering as populateGrid
+        int wordId; // Index into the searched word list
+    };
+
+    //-------------------------------------------------------
+    // GridPool recycles grid buffers so that moving between
+    // levels and sessions reuses memory instead of going
+    // back to the allocator. Buffers are grouped by
+    // power-of-two size class and are cache-line aligned.
+    //-------------------------------------------------------
+    class GridPool {
+    public:
+        static GridPool& instance(); // Process-wide pool
+        char* acquire(std::size_t bytes, std::size_t& capacity); // Gets a buffer of at least 'bytes'
+        void release(char* buffer, std::size_t capacity); // Returns a buffer to the pool
+        void trim(); // Frees every pooled buffer
+        ~GridPool() { trim(); }
+
+    private:
+        GridPool() = default;
+        static const int NUM_CLASSES = 48; // Size classes 2^0 .. 2^47 bytes
+        std::mutex lock; // Guards the free lists
+        std::vector<char*> freeLists[NUM_CLASSES]; // Idle buffers per size class
+    };
+
+    //-------------------------------------------------------
+    // CharGrid is a square, contiguous, row-major letter
+    // grid. Rows can be padded to a cache-line stride.
+    // Storage comes from GridPool and is handed back when
+    // the grid is released or destroyed. A view instead
+    // points at cells someone else owns, such as a tile of
+    // a TiledGrid; copying a view makes an owning grid.
     //-------------------------------------------------------
-    // Game class manages the main game functionalities.
-    // Includes a default constructor and public member
-    // functions for displaying menus, instructions, scores,
-    // and starting the game.
+    class CharGrid {
+    public:
+        CharGrid() : cells(nullptr), gridSize(0), rowStride(0), capacity(0) {}
+        explicit CharGrid(int size, bool padRows = false) : CharGrid() { reset(size, padRows); }
+        CharGrid(const CharGrid& other);
+        CharGrid(CharGrid&& other) noexcept;
+        CharGrid& operator=(CharGrid other) noexcept;
+        ~CharGrid() { release(); }
+
+        static CharGrid view(char* cells, int size, std::size_t stride); // Non-owning grid over existing cells
+
+        void reset(int size, bool padRows = false); // Resizes the grid, reusing pooled storage
+        void release(); // Returns storage to the pool
+        void fill(char ch); // Sets every cell to ch
+
+        bool empty() const { return cells == nullptr; }
+        int size() const { return gridSize; } // Cells per side
+        std::size_t stride() const { return rowStride; } // Bytes between rows
+        bool inBounds(int row, int col) const { return row >= 0 && row < gridSize && col >= 0 && col < gridSize; }
+        char at(int row, int col) const { return cells[row * rowStride + col]; }
+        void set(int row, int col, char ch) { cells[row * rowStride + col] = ch; }
+        char* rowData(int row) { return cells + row * rowStride; }
+        const char* rowData(int row) const { return cells + row * rowStride; }
+
+    private:
+        char* cells; // Row-major cells, rowStride bytes per row
+        int gridSize; // Cells per side
+        std::size_t rowStride; // Row pitch in bytes
+        std::size_t capacity; // Size of the pooled buffer, 0 for a view
+    };
+
+    //-------------------------------------------------------
+    // CellMask holds one bit per cell of a square grid, in
+    // row-major order, packed into 64-bit words. Found
+    // words are marked here rather than in the grid, so the
+    // grid's letters stay intact for later searches and the
+    // grid itself can be shared. Clearing, counting and
+    // marking a run of cells along a row work a word at a
+    // time.
+    //-------------------------------------------------------
+    class CellMask {
+    public:
+        void reset(int size); // Sizes the mask for a grid and clears every cell
+        void release(); // Frees the bits
+        void clear() { std::fill(bits.begin(), bits.end(), 0); } // Clears every cell
+
+        int size() const { return gridSize; } // Cells per side
+        bool test(int row, int col) const { std::size_t cell = index(row, col); return (bits[cell >> 6] >> (cell & 63)) & 1; }
+        void set(int row, int col) { std::size_t cell = index(row, col); bits[cell >> 6] |= std::uint64_t(1) << (cell & 63); }
+        void setRow(int row, int firstCol, int count); // Sets 'count' cells of a row from firstCol
+        std::size_t count() const; // Cells set
+        std::size_t words() const { return bits.size(); } // 64-bit words backing the mask
+        const std::uint64_t* data() const { return bits.data(); }
+        std::uint64_t* data() { return bits.data(); }
+
+    private:
+        std::size_t index(int row, int col) const { return static_cast<std::size_t>(row) * gridSize + col; }
+
+        int gridSize = 0;
+        std::vector<std::uint64_t> bits; // Cell row * size + col is bit (cell % 64) of word cell / 64
+    };
+
+    const int NUM_BIGRAMS = ALPHABET_SIZE * ALPHABET_SIZE; // Letter pairs aa..zz
+
+    //-------------------------------------------------------
+    // GridIndex maps every letter to the cells holding it,
+    // and every bigram to the (cell, direction) pairs where
+    // it starts. It is built once after populateGrid, so a
+    // guess only probes the starts of its first two letters
+    // instead of every cell and direction in the grid.
+    // Both tables are flat arrays sliced by offset, and each
+    // slice is in row-major cell order, then direction.
+    //-------------------------------------------------------
+    class GridIndex {
+    public:
+        void build(const CharGrid& grid); // Indexes the grid's current letters
+        void clear(); // Drops the index
+        bool empty() const { return indexedSize == 0; }
+
+        // Finds the first occurrence of word in row-major, then direction, order.
+        // The grid is re-read to confirm each candidate, so cells changed since
+        // build() can only cause misses, never false matches.
+        bool find(const std::string& word, const CharGrid& grid, WordMatch& match) const;
+
+        std::size_t letterCount(char ch) const; // Cells holding a letter
+        std::size_t bigramCount(char first, char second) const; // Starts of a letter pair
+
+    private:
+        int indexedSize = 0; // Grid size at build time
+        std::vector<std::uint32_t> letterOffsets; // ALPHABET_SIZE + 1 slice bounds
+        std::vector<std::uint32_t> letterCells; // Cell numbers (row * size + col)
+        std::vector<std::uint32_t> bigramOffsets; // NUM_BIGRAMS + 1 slice bounds
+        std::vector<std::uint32_t> bigramStarts; // Cell number * NUM_DIRECTIONS + direction
+    };
+
+    const int NUM_STRIP_FAMILIES = 4; // Rows, columns, diagonals, anti-diagonals
+
+    //-------------------------------------------------------
+    // GridStrips keeps a copy of the grid as four strip
+    // families: rows, columns, diagonals and
+    // anti-diagonals. Each family is one contiguous buffer
+    // with a '\0' between strips, plus the same buffer
+    // reversed, so each of the eight directions becomes a
+    // plain substring search. Letters are stored lowercase.
+    // The game answers guesses from GridIndex; the strips
+    // are kept as the benchmark's scan-based comparison.
+    //-------------------------------------------------------
+    class GridStrips {
+    public:
+        void build(const CharGrid& grid); // Copies the grid's letters into strip order
+        void clear(); // Drops the strips
+        bool empty() const { return indexedSize == 0; }
+
+        std::vector<WordMatch> findAll(const std::string& word) const; // Every occurrence in the snapshot
+        bool find(const std::string& word, const CharGrid& grid, WordMatch& match) const; // First occurrence, if the strips were built from grid
+
+        // Next position >= from where needle occurs in text, or length if none.
+        // Uses an AVX2 or SSE2 first/last character filter when available.
+        static std::size_t findSubstring(const char* text, std::size_t length, const char* needle, std::size_t needleLength, std::size_t from);
+
+    private:
+        struct Family {
+            int direction; // Direction of the forward buffer
+            int reverse; // Direction of the reversed buffer
+            std::vector<char> forward; // Strips back to back, '\0' separated
+            std::vector<char> backward; // forward reversed end to end
+            std::vector<std::uint32_t> stripOffsets; // Offset of each strip in forward
+            std::vector<std::uint32_t> stripCells; // First cell (row * size + col) of each strip
+        };
+
+        template <typename Fn>
+        bool scan(const std::string& word, Fn&& fn) const; // Calls fn(match) until it returns false
+        WordMatch locate(const Family& family, std::size_t position, bool reversed) const; // Maps a buffer offset to a cell
+
+        int indexedSize = 0; // Grid size at build time
+        Family families[NUM_STRIP_FAMILIES];
+    };
+
+    //-------------------------------------------------------
+    // MappedFile exposes a file's bytes read-only. Regular
+    // files are memory-mapped; anything that cannot be
+    // mapped (pipes, character devices, platforms without
+    // mmap) is read into a heap buffer instead.
+    //-------------------------------------------------------
+    class MappedFile {
+    public:
+        static std::shared_ptr<const MappedFile> open(const std::string& path); // Throws runtime_error if unreadable
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* data() const { return bytes; }
+        std::size_t size() const { return length; }
+        bool isMapped() const { return mapped; } // False when the fallback buffer is used
+
+    private:
+        MappedFile() : bytes(nullptr), length(0), mapped(false) {}
+        const char* bytes; // Start of the file contents
+        std::size_t length; // Size in bytes
+        bool mapped; // bytes points into a mapping
+        std::vector<char> buffer; // Contents when the file could not be mapped
+    };
+
+    //-------------------------------------------------------
+    // WordBucket lists the ids of every word of one length.
+    // Compiled dictionaries number each length contiguously,
+    // so they need no id array.
+    //-------------------------------------------------------
+    struct WordBucket {
+        const std::uint32_t* ids; // Word ids, or nullptr when they run from firstId
+        int firstId; // First id when ids is nullptr
+        int count; // Number of words of this length
+
+        int id(int k) const { return ids != nullptr ? static_cast<int>(ids[k]) : firstId + k; }
+    };
+
+    //-------------------------------------------------------
+    // Dictionary is a word list with constant-time lookup.
+    // Words are numbered in load order; duplicates keep
+    // their first id. Lookup goes through an open-addressing
+    // hash table of ids with linear probing, which grows as
+    // words are added, so there is no fixed capacity.
+    // Words loaded from a file are views into its mapping,
+    // which the dictionary keeps alive.
+    //
+    // load() also accepts the binary format written by
+    // writeCompiled(): the records and hash table are used
+    // in place from the mapping, with nothing to parse.
+    //-------------------------------------------------------
+    class AhoCorasick; // Solver.h
+
+    class Dictionary {
+    public:
+        Dictionary() = default;
+        Dictionary(const Dictionary&) = delete; // Views may point into ownedWords
+        Dictionary& operator=(const Dictionary&) = delete;
+        Dictionary(Dictionary&& other) { *this = std::move(other); }
+        Dictionary& operator=(Dictionary&& other); // Moves everything but the automaton lock
+
+        void load(const std::string& filename); // Replaces the contents with a word list or compiled file
+        int add(std::string_view word); // Adds a copy of a word, returns its id
+        int find(std::string_view word) const; // Id of a word, or -1
+        bool contains(std::string_view word) const { return find(word) >= 0; }
+        std::string_view word(int id) const; // Word by id
+        int size() const { return compiled ? compiledWordCount : static_cast<int>(words.size()); } // Number of distinct words
+        bool empty() const { return size() == 0; }
+        WordBucket bucket(int length) const; // Every word of one length
+        std::shared_ptr<const AhoCorasick> lineAutomaton(int length) const; // AhoCorasick::buildLines for a length, built once
+        bool isCompiled() const { return compiled; } // Loaded from the binary format
+        void reserve(std::size_t count); // Pre-sizes storage for count words
+        void clear();
+
+        static std::uint64_t hash(const char* text, std::size_t length); // FNV-1a
+
+        // Writes words (lowercased, without duplicates) to the binary format
+        static void writeCompiled(const std::string& filename, std::vector<std::string> words);
+
+    private:
+        static constexpr std::uint32_t EMPTY_SLOT = UINT32_MAX;
+
+        struct CompiledBucket {
+            int length; // Word length
+            int firstId; // Id of the first record
+            int count; // Number of records
+            const char* records; // count * length bytes, sorted
+        };
+
+        int insert(std::string_view word, bool copy); // Adds a word, copying it into ownedWords if asked
+        void rehash(std::size_t slotCount); // Rebuilds the table with slotCount slots
+        void openCompiled(); // Points the dictionary at a compiled file in source
+        void materialize(); // Turns a compiled dictionary into an editable one
+
+        std::vector<std::string_view> words; // Words by id
+        std::vector<std::uint32_t> slots; // Word ids, power-of-two sized
+        std::vector<std::vector<std::uint32_t>> lengthIds; // Word ids by length
+        std::shared_ptr<const MappedFile> source; // File the views point into
+        std::deque<std::string> ownedWords; // Storage for words added by copy
+
+        bool compiled = false; // Lookups use the tables below
+        int compiledWordCount = 0;
+        const std::uint32_t* compiledSlots = nullptr; // Hash table inside the mapping
+        std::size_t compiledSlotCount = 0;
+        std::vector<CompiledBucket> compiledBuckets; // Non-empty lengths in id order
+
+        mutable std::mutex lineAutomataLock; // Guards lineAutomata, never held while building
+        mutable std::unordered_map<int, std::shared_future<std::shared_ptr<const AhoCorasick>>> lineAutomata; // By length, dropped when words change
+    };
+
+    //-------------------------------------------------------
+    // DictionaryRegistry loads each word file once per
+    // process and hands out shared, read-only copies.
+    // Entries are keyed by path and checked against the
+    // file's modification time and size on every get(), so
+    // an edited list is reloaded while games still holding
+    // the old one keep using it until they let go.
+    // Concurrent callers asking for the same file wait for
+    // a single load.
+    //-------------------------------------------------------
+    class DictionaryRegistry {
+    public:
+        static DictionaryRegistry& instance(); // Process-wide registry
+        std::shared_ptr<const Dictionary> get(const std::string& path); // Loaded dictionary; throws like Dictionary::load
+        void clear(); // Forgets every entry; dictionaries in use stay alive
+
+    private:
+        DictionaryRegistry() = default;
+
+        struct Entry {
+            std::int64_t modified; // File time when loaded
+            std::uintmax_t fileSize; // File size when loaded
+            std::shared_future<std::shared_ptr<const Dictionary>> dictionary; // Ready once loaded
+        };
+
+        std::mutex lock; // Guards entries
+        std::unordered_map<std::string, Entry> entries; // By path as given
+    };
+
+    //-------------------------------------------------------
+    // Game plays one GameSession on the console: it prints
+    // whatever the session answers and feeds it the lines
+    // typed on stdin until the player exits.
     //-------------------------------------------------------
     class Game {
+    public:
+        void displayMenu(); // Runs the menu until the player exits
+    };
+
+    //-------------------------------------------------------
+    // Random is a small seedable generator (xoshiro256**).
+    // Each generator owns one, so grids are reproducible
+    // from a seed and threads never share random state.
+    //-------------------------------------------------------
+    class Random {
+    public:
+        Random() { reseed(freshSeed()); } // Seeded from the clock and the OS
+        explicit Random(std::uint64_t seed) { reseed(seed); }
+
+        void reseed(std::uint64_t seed); // Restarts the sequence for a seed
+        std::uint64_t next() {
+            std::uint64_t result = rotate(state[1] * 5, 7) * 9;
+            std::uint64_t shifted = state[1] << 17;
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= shifted;
+            state[3] = rotate(state[3], 45);
+            return result;
+        }
+        int below(int bound); // Uniform value in [0, bound), bound > 0
+        void fillLetters(char* out, std::size_t count); // Writes count random lowercase letters
+
+        static const int STATE_WORDS = 4; // 64-bit words of generator state
+        void saveState(std::uint64_t out[STATE_WORDS]) const { std::copy(state, state + STATE_WORDS, out); } // Copies the generator state
+        void restoreState(const std::uint64_t saved[STATE_WORDS]) { std::copy(saved, saved + STATE_WORDS, state); } // Continues from a saved state
+
+        static std::uint64_t freshSeed(); // Non-repeating seed for interactive play
+        static std::uint64_t deriveSeed(std::uint64_t base, std::uint64_t index); // Independent seed for item 'index' of a batch
+
     private:
-        int chances;
+        static std::uint64_t rotate(std::uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+        std::uint64_t state[STATE_WORDS];
+    };
 
+    //-------------------------------------------------------
+    // PlacementResult reports how populateGrid went: how
+    // many words were placed out of how many requested,
+    // how much work that took and how much of the grid
+    // the placed words cover.
+    //-------------------------------------------------------
+    struct PlacementResult {
+        int placed; // Words placed in the grid
+        int requested; // Words asked for
+        int attempts; // Placement tries used
+        int backtracks; // Placements undone by the backtracking engine
+        double density; // Fraction of cells covered by placed words
+        double milliseconds; // Time spent in populateGrid
+
+        double successRate() const { return requested > 0 ? static_cast<double>(placed) / requested : 1.0; }
+    };
+
+    std::ostream& operator<<(std::ostream& out, const PlacementResult& result); // One-line report
+
+    //-------------------------------------------------------
+    // Word placement engines a GameMode can generate with.
+    // RandomProbe tries random starts per word; Backtracking
+    // runs a constraint search that packs dense grids.
+    //-------------------------------------------------------
+    enum class GeneratorEngine { RandomProbe, Backtracking };
+
+    //-------------------------------------------------------
+    // BacktrackingGenerator places words as a constraint
+    // search. From a pool of unplaced words it takes the one
+    // with the fewest legal placements (most constrained),
+    // tries its placements with the most crossings first,
+    // and backtracks to the previous word's next placement
+    // when no remaining word fits. Crossing letters are
+    // checked against the grid as it is built up and torn
+    // down, and a node budget bounds the search.
+    //-------------------------------------------------------
+    class BacktrackingGenerator {
+    public:
+        BacktrackingGenerator(CharGrid& grid, const Dictionary& words, int wordLength, Random& random)
+            : grid(grid), words(words), wordLength(wordLength), random(random) {}
+        PlacementResult run(int targetWordCount); // Places up to targetWordCount words in an empty grid
+
+    private:
+        struct Option {
+            int row; // First letter
+            int col;
+            int direction;
+            int crossings; // Letters shared with words already placed
+        };
+        struct Frame {
+            int wordId; // Word placed at this depth
+            std::vector<Option> options; // Its legal placements, best first
+            std::size_t next; // Option currently applied
+            std::vector<int> written; // Cells this placement filled
+        };
+
+        std::vector<Option> legalPlacements(std::string_view word, std::size_t limit) const; // Placements that fit, up to limit + 1
+        void apply(Frame& frame); // Writes the frame's current option
+        void undo(Frame& frame); // Clears the cells the frame wrote
+
+        CharGrid& grid;
+        const Dictionary& words;
+        int wordLength;
+        Random& random;
+    };
+
+    //-------------------------------------------------------
+    // Puzzle is a finished grid with its lookup index and
+    // placement report. It is built apart from any GameMode
+    // so that a worker thread can prepare one while the
+    // current level is being played.
+    //-------------------------------------------------------
+    struct Puzzle {
+        int level = 0; // Level the grid was built for
+        CharGrid grid;
+        GridIndex index;
+        PlacementResult placement = { 0, 0, 0, 0, 0.0, 0.0 };
+    };
+
+    //-------------------------------------------------------
+    // TiledGrid is a grid too large to keep in memory, for
+    // bulk generation and solving. Its cells live in a
+    // memory-mapped scratch file as square tiles, and a
+    // tile is generated on first access. Each stored tile
+    // carries a halo: a border of 'halo' cells copied from
+    // its neighbours, so a word of up to halo + 1 letters
+    // that starts in a tile lies wholly inside the stored
+    // tile, and tiles can be searched on their own.
+    //
+    // Placement is planned per tile: a tile's words start
+    // in it and may reach into its neighbours' cores. The
+    // tiles are coloured by row and column parity, and a
+    // tile's plan is checked against the plans of the
+    // neighbours with a lower colour, so plans never
+    // disagree on a cell and any tile can be generated
+    // first. Background letters are a hash of the seed and
+    // the cell.
+    //
+    // tile() hands out a CharGrid view of a stored tile and
+    // window() copies any square region, so the scan and
+    // placement kernels, GridSolver and the renderers work
+    // on a TiledGrid through the usual grid interface.
+    //-------------------------------------------------------
+    class TiledGrid {
     public:
-        Game(); // Default constructor to initialize game settings
-        void displayMenu(); // Displays the main menu
-        void displayInstructions(); // Shows game instructions
-        void HighestScore(); // Displays the highest scores
-        void AboutUs(); // Provides information about developers
-        void startGame(); // Starts the game logic
+        struct Settings {
+            int size = 0; // Cells per side
+            int tileSize = 1024; // Core cells per tile side, more than 2 * halo
+            int halo = 0; // Border cells per side; 0 means wordLength - 1
+            int wordLength = 0; // Length of the placed words
+            int wordsPerTile = 0; // Words to place in each tile
+            std::uint64_t seed = 0;
+        };
+
+        TiledGrid(const std::string& path, std::shared_ptr<const Dictionary> words, const Settings& settings); // Creates the scratch file
+        ~TiledGrid(); // Unmaps and removes the scratch file
+        TiledGrid(const TiledGrid&) = delete;
+        TiledGrid& operator=(const TiledGrid&) = delete;
+
+        int size() const { return gridSize; }
+        int tileSize() const { return coreSize; }
+        int halo() const { return haloSize; }
+        int tilesPerSide() const { return tileCount; }
+        bool inBounds(int row, int col) const { return row >= 0 && row < gridSize && col >= 0 && col < gridSize; }
+        char at(int row, int col) const; // Cell, generating its tile if needed
+        const CharGrid& tile(int tileRow, int tileCol) const; // Stored tile with its halo, generated if needed
+        int tileStart(int tile) const { return tile * coreSize - haloSize; } // Grid row (or column) of a stored tile's first cell
+        CharGrid window(int row, int col, int size) const; // Copy of a square region; cells outside the grid are ' '
+        bool find(std::string_view word, WordMatch& match) const; // First start, tile by tile in row-major order
+        PlacementResult generateAll(int threads); // Generates every tile in parallel, reports the whole grid
+
+    private:
+        struct PlannedWord {
+            int row; // First letter, grid coordinates
+            int col;
+            int direction;
+            int wordId;
+        };
+        struct Plan {
+            std::vector<PlannedWord> words;
+            int attempts = 0;
+        };
+
+        int tileIndex(int tileRow, int tileCol) const { return tileRow * tileCount + tileCol; }
+        std::shared_ptr<const Plan> plan(int tileRow, int tileCol) const; // Memoized plan of a tile
+        Plan makePlan(int tileRow, int tileCol) const; // Places a tile's words around its lower-coloured neighbours' words
+        int colour(int tileRow, int tileCol) const { return (tileRow & 1) * 2 + (tileCol & 1); }
+        void drawPlans(CharGrid& view, int tileRow, int tileCol, int belowColour) const; // Writes the words of nearby plans below a colour
+        void generate(int tileRow, int tileCol) const; // Writes a stored tile
+
+        std::shared_ptr<const Dictionary> words;
+        int gridSize;
+        int coreSize;
+        int haloSize;
+        int storedSize; // coreSize + 2 * haloSize
+        int tileCount; // Tiles per side
+        int wordLength;
+        int wordsPerTile;
+        std::uint64_t seed;
+
+        std::string path; // Scratch file
+        char* cells = nullptr; // Mapped tiles, tileBytes each, in row-major tile order
+        std::size_t tileBytes = 0; // storedSize^2 rounded up to a page
+        std::size_t mappedBytes = 0;
+        std::vector<char> buffer; // Storage where mmap is unavailable
+        mutable std::vector<CharGrid> views; // View of each stored tile
+        mutable std::unique_ptr<std::atomic<int>[]> states; // TileState per tile
+        mutable std::vector<int> covered; // Core cells holding placed letters, per generated tile
+        mutable std::mutex plansLock; // Guards plans
+        mutable std::unordered_map<int, std::shared_ptr<const Plan>> plans; // By tile index
     };
 
     //-------------------------------------------------------
@@ -42,25 +590,49 @@ namespace WordGame {
     //-------------------------------------------------------
     class GameMode {
     protected:
-        char** grid; // Pointer to a 2D character grid
-        int gridSize; // Size of the grid
-        std::string wordList[MAX_WORDS]; // List of words in the game
+        CharGrid grid; // Contiguous character grid
+        GridIndex index; // Letter and bigram starts, rebuilt after populateGrid
+        PlacementResult placement; // Outcome of the last populateGrid
+        GeneratorEngine generator; // Engine used by populateGrid
+        Random random; // Source for Grid(); populateGrid takes its own
+        int gridSizeOverride; // Grid size used instead of GRID_SIZES when non-zero
+        int wordCountOverride; // Words to place instead of getWordCount when non-zero
         int wordCount; // Total words used in the grid
         int level; // Current level
 
     public:
-        GameMode() : grid(nullptr), gridSize(0), wordCount(0), level(1) {} // Constructor initializes variables
+        GameMode() : placement{ 0, 0, 0, 0, 0.0, 0.0 }, generator(GeneratorEngine::RandomProbe), gridSizeOverride(0), wordCountOverride(0), wordCount(0), level(1) {} // Constructor initializes variables
         virtual ~GameMode() { clearGrid(); } // Destructor clears grid memory
         virtual void Grid(const std::string& level, const std::string& filename) = 0; // Sets up the grid based on level
         virtual int getWordLength(int level) const = 0; // Gets word length for a level
         virtual int getWordCount(int level) const = 0; // Gets word count for a level
 
-        char** getGrid() const { return grid; }
-        int getGridSize() const { return gridSize; } // Returns grid size
-        void clearGrid(); // Clears dynamically allocated grid memory
-        void printGrid(); // Prints the grid to the console
+        CharGrid& getGrid() { return grid; }
+        const CharGrid& getGrid() const { return grid; }
+        const GridIndex& getIndex() const { return index; }
+        int getGridSize() const { return grid.size(); } // Returns grid size
+        int gridSizeForLevel(int level) const; // GRID_SIZES entry or the override
+        void setGridSize(int size) { gridSizeOverride = size; } // Overrides GRID_SIZES (0 restores it)
+        int wordCountForLevel(int level) const { return wordCountOverride > 0 ? wordCountOverride : getWordCount(level); } // Words to place
+        void setWordCount(int count) { wordCountOverride = count; } // Overrides getWordCount for generation (0 restores it)
+        void setGenerator(GeneratorEngine engine) { generator = engine; } // Selects the placement engine
+        GeneratorEngine getGenerator() const { return generator; }
+        void setSeed(std::uint64_t seed) { random.reseed(seed); } // Makes the next Grid() calls reproducible
+        void clearGrid(); // Returns grid memory to the pool
+        void printGrid(std::ostream& out = std::cout) const { printGrid(grid, out); } // Prints the grid with borders
+        static void printGrid(const CharGrid& grid, std::ostream& out); // Prints any grid with borders
+        static void printGrid(const CharGrid& grid, const CellMask& found, std::ostream& out); // Same, with found cells highlighted
         void allocateGrid(int size); // Allocates memory for the grid
-        void populateGrid(const std::string words[], int totalWords, int targetWordCount, int targetWordLength); // Fills grid with words
+        PlacementResult populateGrid(const Dictionary& words, int targetWordCount, int targetWordLength, Random& random); // Fills grid with words
+        const PlacementResult& getPlacement() const { return placement; } // Outcome of the last populateGrid
+        Puzzle makePuzzle(const Dictionary& words, int level, Random& random) const; // Builds a level's grid without touching this mode
+        void adopt(Puzzle puzzle); // Makes a prebuilt puzzle the current grid
+
+    protected:
+        static PlacementResult generate(CharGrid& grid, GridIndex& index, GeneratorEngine engine, const Dictionary& words,
+            int targetWordCount, int targetWordLength, Random& random); // Shared body of populateGrid and makePuzzle
+        static PlacementResult placeWordsRandomly(CharGrid& grid, const Dictionary& words, int targetWordCount, int targetWordLength, Random& random); // RandomProbe engine
+        static long long fillBackground(CharGrid& grid, const AhoCorasick& lines, Random& random); // Letters for the empty cells; returns the cells already covered
     };
 
     //-------------------------------------------------------
@@ -87,34 +659,349 @@ namespace WordGame {
         int getWordCount(int level) const override; // Returns word count
     };
 
+    //-------------------------------------------------------
+    // GridPrefetcher builds upcoming grids on worker threads
+    // while the player is busy with the current one. Grids
+    // are requested per level and handed over through
+    // futures; take() only blocks if the grid it wants is
+    // still being built. The mode and dictionary must
+    // outlive the prefetcher, and the mode's settings must
+    // not change while it is alive.
+    //-------------------------------------------------------
+    class GridPrefetcher {
+    public:
+        GridPrefetcher(const GameMode& mode, const Dictionary& words, std::uint64_t seed)
+            : mode(mode), words(words), seed(seed), jobsStarted(0) {}
+        ~GridPrefetcher(); // Waits for grids still being built
+        GridPrefetcher(const GridPrefetcher&) = delete;
+        GridPrefetcher& operator=(const GridPrefetcher&) = delete;
+
+        void prefetch(int level); // Starts building a grid for level unless one is already waiting
+        Puzzle take(int level); // Waiting grid for level, or one built now; drops grids for lower levels
+
+    private:
+        struct Job {
+            int level; // Level being built
+            std::future<Puzzle> puzzle; // Result of the worker
+        };
+
+        void reap(); // Forgets dropped jobs that have finished
+
+        const GameMode& mode;
+        const Dictionary& words;
+        std::uint64_t seed; // Base seed, each job derives its own
+        std::uint64_t jobsStarted; // Jobs started so far, numbers the derived seeds
+        std::deque<Job> jobs; // Grids being built or ready, oldest first
+        std::vector<std::future<Puzzle>> dropped; // Unwanted grids still being built
+    };
+
     //-------------------------------------------------------
     // WordValidator class validates words by checking
-    // their presence in the dictionary or grid.
+    // their presence in the dictionary or grid. The full
+    // scan splits grids of PARALLEL_SEARCH_MIN_CELLS or
+    // more into row bands searched on several threads.
     //-------------------------------------------------------
     class WordValidator {
     public:
-        bool isValidWord(const std::string& word, const std::string dictionary[], int dictionarySize); // Checks if word exists in dictionary
-        bool checkWordInGrid(std::string word, char** grid, int gridSize); // Searches word in grid
-        void loadWords(const std::string& filename, std::string words[], int& wordSize); // Loads words from file
+        void setSearchThreads(int threads) { searchThreads = threads; } // Workers for large scans: 0 one per core, 1 serial
+        bool isValidWord(const std::string& word, const Dictionary& dictionary); // Checks if word exists in dictionary
+        bool checkWordInGrid(std::string word, const CharGrid& grid, CellMask& found); // Searches word in grid
+        bool checkWordInGrid(std::string word, const CharGrid& grid, const GridIndex& index, CellMask& found); // Searches word using the grid index
+        bool markWord(const std::string& word, CellMask& found, const WordMatch& match); // Marks a matched word's cells as found; false for an empty word
+        void loadWords(const std::string& filename, Dictionary& words); // Loads words from file
+
+    private:
+        int searchThreads = 0;
     };
 
     //-------------------------------------------------------
-    // ScoreTracker class tracks and manages scores for the
-    // game.
+    // ScoreTracker keeps the running score of a game.
+    // Finished games are recorded in ScoreStore.
     //-------------------------------------------------------
     class ScoreTracker {
     public:
-        ScoreTracker() : score(0) { std::fill(topScores, topScores + 5, 0); } // Initializes with zero score
+        ScoreTracker() : score(0) {} // Initializes with zero score
         void updateScore(bool correctGuess); // Updates score based on guesses
-        void loadScores(const std::string& filename); // Loads scores from file
-        void saveScores(const std::string& filename); // Saves scores to file
         int getScore() const; // Gets current score
-        int getTopScore(int index) const; // Gets top score from list
-        void compareAndUpdateScores(const std::string& filename); // Updates high scores
+        void restoreScore(int saved) { score = saved; } // Continues from a saved score
 
     private:
         int score; // Current score
-        int topScores[5]; // Top 5 scores
     };
 
+    //-------------------------------------------------------
+    // ScoreEntry is one finished game: the mode and level
+    // it ended on, who played it and the score.
+    //-------------------------------------------------------
+    struct ScoreEntry {
+        int mode; // 1 Easy, 2 Hard
+        int level; // Level the game ended on
+        std::uint64_t player; // Player id
+        int score;
+        std::int64_t time; // Seconds since the epoch
+    };
+
+    //-------------------------------------------------------
+    // Leaderboard ranks players by their best score, ties
+    // going to whoever got there first. It is a treap
+    // ordered by rank with subtree sizes, so submitting a
+    // score, a player's rank and percentile all take
+    // O(log n), and the top k take O(log n + k). Nodes live
+    // in one vector and link by index.
+    //-------------------------------------------------------
+    class Leaderboard {
+    public:
+        bool submit(const ScoreEntry& entry); // Keeps the entry if it beats the player's best; true if it did
+        std::vector<ScoreEntry> top(int count) const; // Highest ranked first
+        int rank(std::uint64_t player) const; // 1 for the best player, 0 if not on the board
+        double percentile(std::uint64_t player) const; // Percent of players ranked at or below, 0 if not on the board
+        const ScoreEntry* best(std::uint64_t player) const; // Player's entry, nullptr if none
+        int size() const { return static_cast<int>(byPlayer.size()); }
+        void forEach(const std::function<void(const ScoreEntry&)>& fn) const; // Every entry, in no particular order
+
+    private:
+        struct Node {
+            ScoreEntry entry;
+            std::uint32_t priority; // Heap order keeps the tree balanced
+            int left; // Node index, -1 for none
+            int right;
+            int count; // Nodes in this subtree
+        };
+
+        static bool ahead(const ScoreEntry& a, const ScoreEntry& b); // Rank order
+        int countOf(int node) const { return node < 0 ? 0 : nodes[node].count; }
+        void update(int node) { nodes[node].count = 1 + countOf(nodes[node].left) + countOf(nodes[node].right); }
+        void split(int node, const ScoreEntry& key, bool keyGoesLeft, int& left, int& right); // Nodes ahead of key (and key itself if keyGoesLeft) go left
+        int merge(int left, int right); // Every node of left ranks ahead of right
+        void erase(const ScoreEntry& entry);
+        void insert(const ScoreEntry& entry);
+
+        std::vector<Node> nodes;
+        std::vector<int> freeNodes; // Indices to reuse
+        int root = -1;
+        std::unordered_map<std::uint64_t, int> byPlayer; // Player -> node
+        Random priorities{ 0x1eade7b0a7dULL };
+    };
+
+    //-------------------------------------------------------
+    // ScoreStore keeps every player's best score per mode
+    // and level. Scores are appended to a log of
+    // checksummed records by a background writer, which
+    // commits whatever queued up since its last write with
+    // a single fsync, so a game never waits for the disk.
+    // Every so often the writer compacts: it writes the
+    // current bests to a snapshot file, renames it into
+    // place and empties the log. Opening replays the
+    // snapshot, then the log, and cuts off a record torn
+    // by a crash.
+    //-------------------------------------------------------
+    class ScoreStore {
+    public:
+        explicit ScoreStore(const std::string& basePath); // Uses basePath.log and basePath.snapshot; throws runtime_error if unreadable
+        ~ScoreStore(); // Writes what is queued, then stops the writer
+        ScoreStore(const ScoreStore&) = delete;
+        ScoreStore& operator=(const ScoreStore&) = delete;
+
+        static ScoreStore& instance(); // Process-wide store over "scores" in the working directory
+
+        void append(const ScoreEntry& entry); // Records a game; returns without touching the disk
+        std::vector<ScoreEntry> top(int mode, int level, int count) const; // Best scores, one per player, highest first
+        int rank(int mode, int level, std::uint64_t player) const; // Player's place on a board, 0 if absent
+        double percentile(int mode, int level, std::uint64_t player) const; // Percent of the board at or below the player
+        int boardSize(int mode, int level) const; // Players on a board
+        void sync(); // Waits until every earlier append is on disk
+        void compact(); // Asks the writer for a snapshot now
+        std::size_t playerCount() const; // Entries over every mode and level
+
+    private:
+        void replay(const std::string& path, bool truncateTornTail); // Applies a file's records if it exists
+        void apply(const ScoreEntry& entry); // Keeps the entry if it is the player's best
+        void writerLoop(); // Background writer
+        void writeBatch(const std::vector<ScoreEntry>& batch); // Appends and syncs once
+        void writeSnapshot(); // Compaction
+
+        std::string logPath;
+        std::string snapshotPath;
+        int logFd; // Append-only descriptor of the log, -1 without POSIX files
+        std::size_t logRecords; // Records in the log since the last compaction
+
+        const Leaderboard* board(int mode, int level) const; // nullptr if nothing was recorded; call with stateLock held
+
+        mutable std::mutex stateLock; // Guards boards
+        std::unordered_map<int, Leaderboard> boards; // By mode and level
+
+        std::mutex queueLock; // Guards everything down to compactRequested
+        std::condition_variable wake; // Writer waits for work
+        std::condition_variable written; // sync() waits for the writer
+        std::vector<ScoreEntry> pending; // Appended, not yet written
+        std::uint64_t appended; // Appends so far
+        std::uint64_t durable; // Appends known to be on disk (or dropped after an error)
+        bool stopping;
+        bool compactRequested;
+        std::thread writer;
+    };
+
+    //-------------------------------------------------------
+    // GridRenderer draws a grid on an ANSI terminal. Each
+    // frame is built in one reusable buffer so it goes out
+    // in a single write. The renderer remembers what is on
+    // screen, so after a guess only the cells that changed
+    // are sent, each behind a cursor move. A grid larger
+    // than the terminal is shown through a viewport that
+    // can be scrolled. appendGrid() gives the same layout
+    // as plain text. Cells set in a found mask are drawn
+    // in capitals, and in reverse video on the terminal.
+    //-------------------------------------------------------
+    class GridRenderer {
+    public:
+        static bool terminalSize(int& rows, int& cols); // Size of the terminal on stdout, false if it is not one
+        static void appendGrid(std::string& out, const CharGrid& grid, const CellMask* found = nullptr); // Whole grid with borders, as plain lines
+
+        void layout(int size, int firstLine, int screenRows, int screenCols, int reservedRows); // Fits a grid below screen row firstLine
+        const std::string& drawFrame(const CharGrid& grid, const CellMask* found = nullptr); // Redraws the viewport
+        const std::string& drawChanges(const CharGrid& grid, const CellMask* found = nullptr); // Cells changed or newly found since the last draw, cursor kept
+        bool scroll(int rowSteps, int colSteps); // Moves the viewport by half pages
+        bool clipped() const { return viewRows < gridSize || viewCols < gridSize; } // Part of the grid is off screen
+        int bottom() const { return top + 2 * viewRows + 2; } // First screen row under the grid
+        std::string clearBelow() const; // Moves to bottom() and clears the rest of the screen
+        void describeViewport(std::ostream& out) const; // Which part is visible and how to scroll
+
+    private:
+        static void appendLine(std::string& out, const CharGrid& grid, const CellMask* found, bool terminal, int line, int firstRow, int rowCount, int firstCol, int colCount);
+        void appendMoveTo(int row, int col); // Cursor move, 1-based
+
+        std::string frame; // Output buffer, reused between draws
+        std::string shown; // Letter on screen per cell, capital if shown found, '\0' if not drawn
+        int gridSize = 0;
+        int top = 1; // Screen row of the column numbers
+        int viewRow = 0; // First visible grid row
+        int viewCol = 0; // First visible grid column
+        int viewRows = 0; // Visible grid rows
+        int viewCols = 0; // Visible grid columns
+    };
+
+    //-------------------------------------------------------
+    // GameSession is the whole game (menu, mode and level
+    // selection, guessing, retries and scores) as a state
+    // machine that reads one input line at a time and
+    // returns the text to show. It never blocks on input,
+    // so the console and the network server drive the same
+    // logic. Console sessions clear the screen between
+    // menus and build upcoming grids in the background.
+    //
+    // A server holds one session per client, so the layout
+    // is kept tight: modes are shared read-only rules,
+    // found words are dictionary ids in a fixed array, and
+    // the level's grid is a pooled block reused from level
+    // to level and session to session. The grid's lookup
+    // index is kept beside it, so a guess only probes the
+    // starts of its first two letters. The grid is never
+    // written while playing: found cells are bits in a
+    // mask beside it. An idle session allocates nothing.
+    //
+    // There is no per-session arena. The grid's block comes
+    // from the process-wide GridPool; the index and mask
+    // are ordinary heap buffers, and endGame frees all
+    // three.
+    //
+    // save() writes the session as a compact binary
+    // snapshot and restore() continues from one, so a
+    // server can park an idle session on disk and bring it
+    // back when its client returns.
+    //-------------------------------------------------------
+    class GameSession {
+    public:
+        GameSession(std::uint64_t seed, bool console);
+        GameSession(const GameSession&) = delete;
+        GameSession& operator=(const GameSession&) = delete;
+
+        std::string start(); // Opening menu
+        std::string handleLine(const std::string& line); // Applies one line of input and returns the reply
+        bool finished() const { return state == State::Closed; } // Player chose to exit
+
+        void save(std::string& out) const; // Appends a snapshot of the session to out
+        void restore(const char* data, std::size_t size); // Continues from a snapshot; throws runtime_error if it is not a valid one
+        std::string resume(); // Shows a restored session where it stopped: its grid and prompt
+
+        static std::string wordListFile(int modeSel); // Compiled word list if present, else the text list
+
+    private:
+        enum class State : std::uint8_t { MainMenu, Paused, SelectMode, SelectLevel, Guessing, AskRetry, AskContinue, Closed };
+
+        static const int MAX_FOUND_WORDS = 16; // Words over levels 1 to 3 (3 + 5 + 7), rounded up
+
+        void showMenu(std::ostream& out);
+        void showModes(std::ostream& out);
+        void showLevels(std::ostream& out);
+        void onMenu(const std::string& line, std::ostream& out);
+        void onMode(const std::string& line, std::ostream& out);
+        void onLevel(const std::string& line, std::ostream& out);
+        void onGuess(const std::string& line, std::ostream& out);
+        void beginLevel(int levelNum, std::ostream& out); // Shows the level's grid and starts guessing
+        void endLevel(std::ostream& out); // Reports the level and asks what next
+        void endGame(std::ostream& out); // Records the score and returns to the menu
+        void clearScreen(std::ostream& out) const;
+
+        Random random; // Grids for levels built here
+        std::shared_ptr<const Dictionary> dictionary; // Mode's word list
+        std::unique_ptr<GridPrefetcher> prefetcher; // Console sessions only
+        std::unique_ptr<GridRenderer> screen; // Console sessions on a terminal only
+        const GameMode* mode; // Shared rules of the selected mode, nullptr outside a game
+        CharGrid board; // Grid being played, read-only once the level starts
+        GridIndex boardIndex; // Lookup index of board, built with the puzzle
+        CellMask foundCells; // Cells of the board covered by found words
+        ScoreTracker scoreTracker;
+        std::uint64_t player; // Id the session's scores are recorded under
+        std::int32_t found[MAX_FOUND_WORDS]; // Ids of words found since the game or retry started
+        std::int16_t foundCount; // Entries used in found
+        std::int16_t modeSel; // 1 Easy, 2 Hard
+        std::int16_t level; // Level being played
+        std::int16_t chances; // Chances left in this game
+        std::int16_t wordCount; // Words to find in this level
+        std::int16_t successfulGuesses; // Words found in this level
+        State state;
+        bool console; // Clear screens and prefetch grids
+    };
+
+    //-------------------------------------------------------
+    // parallelFor calls body(index) for every index in
+    // [0, count) on 'threads' workers (0 means one per
+    // core). Workers start with equal slices; one that runs
+    // dry steals the back half of the largest slice left,
+    // so uneven items still keep every core busy. The first
+    // exception thrown by body is rethrown once all workers
+    // have stopped. The calling thread is one of the
+    // workers; the others come from a pool of threads kept
+    // between calls.
+    //-------------------------------------------------------
+    void parallelFor(int count, int threads, const std::function<void(int)>& body);
+    int hardwareThreads(); // Cores available, at least 1
+
+    //-------------------------------------------------------
+    // ServerOptions configures runServer. Clients connect
+    // over TCP, or over a Unix socket when unixPath is set.
+    //-------------------------------------------------------
+    struct ServerOptions {
+        std::string host = "127.0.0.1"; // TCP address to listen on
+        int port = 7070; // TCP port
+        std::string unixPath; // Unix socket path, replaces TCP when set
+        int loops = 1; // Event loops, one thread each (0 means one per core)
+        int maxLineLength = 256; // Longer input lines close the connection
+    };
+
+    //-------------------------------------------------------
+    // runServer hosts a GameSession per client on epoll
+    // event loops (Linux only). The protocol is the console
+    // itself: the client sends one line per input and gets
+    // back the text the console would print, without screen
+    // clearing. Runs until SIGINT or SIGTERM.
+    //-------------------------------------------------------
+    int runServer(const ServerOptions& options);
+
+    //-------------------------------------------------------
+    // Command line entry point for the non-interactive
+    // modes. Returns the process exit code.
+    //-------------------------------------------------------
+    int runCommandLine(int argc, char* argv[]);
+
 } // namespace WordGame
\ No newline at end of file
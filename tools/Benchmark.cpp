@@ -0,0 +1,588 @@
+#include "../header.h"
+#include "../Solver.h"
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <sstream>
+
+//------------------------------------------------------------------------------
+// Benchmark
+// Times the game's hot paths over a sweep of grid sizes, dictionary sizes and
+// the word lengths of the easy and hard levels, and writes the results as
+// JSON, one result per line. Inputs are synthetic and seeded, and every batch
+// repeats identical work, so the numbers only move when the code (or the
+// machine) does. --rounds repeats the sweep and keeps each case's best round,
+// which rides out stretches where the machine is busy with something else.
+// --compare checks a run against a saved baseline and fails if any case got
+// slower than the tolerance allows.
+//
+// Usage: wordbench [--quick] [--filter text] [--samples n] [--rounds n] [--out file]
+//                  [--compare baseline.json] [--tolerance 0.25]
+//------------------------------------------------------------------------------
+
+namespace {
+
+    using namespace WordGame;
+
+    struct Settings {
+        bool quick = false; // Smaller sweep, for a fast check
+        std::string filter; // Only cases whose name contains this
+        int samples = 5; // Timed samples per case, the median is reported
+        int rounds = 1; // Sweeps to run, each case keeps its best
+        double sampleSeconds = 0.02; // Minimum time per sample
+        std::string outPath; // JSON destination, stdout when empty
+        std::string baselinePath; // Baseline to compare against
+        double tolerance = 0.25; // Allowed slowdown against the baseline
+    };
+
+    struct Result {
+        std::string name; // Case name, stable across runs
+        double nsPerOp; // Median over samples
+        double minNsPerOp; // Fastest sample
+        long long ops; // Operations timed in total
+    };
+
+    const std::uint64_t BENCH_SEED = 0x5eed;
+    volatile long long sink = 0; // Keeps results from being optimized away
+
+    // Discards everything written to it, for timing formatting alone
+    class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int ch) override { return ch; }
+        std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+    };
+
+    double secondsSince(std::chrono::steady_clock::time_point started) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+
+    //--------------------------------------------------------------------------
+    // measure
+    // Times batch(), which performs opsPerBatch operations. reset() runs
+    // before every batch, outside the timing, so a batch that changes its
+    // input (a hit sets bits in the found mask) repeats the same work each
+    // time. A calibration batch picks how many batches make up a sample.
+    //--------------------------------------------------------------------------
+    Result measure(const std::string& name, int opsPerBatch, const std::function<void()>& reset,
+        const std::function<void()>& batch, const Settings& settings) {
+        reset();
+        auto started = std::chrono::steady_clock::now();
+        batch();
+        double once = std::max(secondsSince(started), 1e-9);
+        long long batches = std::max(1LL, static_cast<long long>(settings.sampleSeconds / once));
+        int samples = once > 0.25 ? std::min(settings.samples, 3) : settings.samples;
+
+        std::vector<double> perOp;
+        for (int s = 0; s < samples; ++s) {
+            double total = 0.0;
+            for (long long b = 0; b < batches; ++b) {
+                reset();
+                started = std::chrono::steady_clock::now();
+                batch();
+                total += secondsSince(started);
+            }
+            perOp.push_back(total * 1e9 / (static_cast<double>(batches) * opsPerBatch));
+        }
+        std::sort(perOp.begin(), perOp.end());
+        Result result = { name, perOp[perOp.size() / 2], perOp.front(), static_cast<long long>(samples) * batches * opsPerBatch };
+        std::cerr << "  " << name << ": " << result.nsPerOp << " ns/op" << std::endl;
+        return result;
+    }
+
+    // Random lowercase word of the given length
+    std::string randomWord(Random& random, int length) {
+        std::string word(static_cast<std::size_t>(length), 'a');
+        for (char& ch : word) {
+            ch = static_cast<char>('a' + random.below(ALPHABET_SIZE));
+        }
+        return word;
+    }
+
+    // 'count' seeded words with lengths spread over the level lengths
+    std::vector<std::string> syntheticWords(int count, const std::vector<int>& lengths) {
+        Random random(BENCH_SEED + static_cast<std::uint64_t>(count));
+        std::vector<std::string> words;
+        words.reserve(static_cast<std::size_t>(count));
+        for (int i = 0; i < count; ++i) {
+            words.push_back(randomWord(random, lengths[random.below(static_cast<int>(lengths.size()))]));
+        }
+        return words;
+    }
+
+    class Suite {
+    public:
+        explicit Suite(const Settings& settings) : settings(settings) {}
+
+        void run();
+        const std::vector<Result>& results() const { return done; }
+
+    private:
+        bool wanted(const std::string& name) const { return settings.filter.empty() || name.find(settings.filter) != std::string::npos; }
+        void add(const std::string& name, int opsPerBatch, const std::function<void()>& reset, const std::function<void()>& batch);
+
+        void generation(const Dictionary& words);
+        void search(const Dictionary& words);
+        void solving(const Dictionary& words);
+        void lookup(const std::vector<int>& dictionarySizes);
+        void loading(const std::vector<int>& dictionarySizes);
+        void rendering();
+        void scores();
+
+        const Settings& settings;
+        std::vector<int> gridSizes;
+        std::vector<int> lengths; // Easy then hard level word lengths
+        std::vector<Result> done;
+    };
+
+    void Suite::add(const std::string& name, int opsPerBatch, const std::function<void()>& reset, const std::function<void()>& batch) {
+        if (wanted(name)) {
+            done.push_back(measure(name, opsPerBatch, reset, batch, settings));
+        }
+    }
+
+    void Suite::run() {
+        EasyMode easy;
+        HardMode hard;
+        for (const GameMode* mode : { static_cast<const GameMode*>(&easy), static_cast<const GameMode*>(&hard) }) {
+            for (int level = 1; level <= 3; ++level) {
+                lengths.push_back(mode->getWordLength(level));
+            }
+        }
+        gridSizes = settings.quick ? std::vector<int>{ 10, 20, 64, 256 } : std::vector<int>{ 10, 20, 64, 256, 1024, 4096 };
+        std::vector<int> dictionarySizes = settings.quick ? std::vector<int>{ 100, 10000, 100000 }
+            : std::vector<int>{ 100, 1000, 10000, 100000, 1000000 };
+
+        Dictionary words;
+        for (const std::string& word : syntheticWords(10000, lengths)) {
+            words.add(word);
+        }
+        generation(words);
+        search(words);
+        solving(words);
+        lookup(dictionarySizes);
+        loading(dictionarySizes);
+        rendering();
+        scores();
+    }
+
+    //--------------------------------------------------------------------------
+    // generation
+    // populateGrid with each engine, placing size / 2 words (at least 3).
+    // The backtracking search is bounded by its budget rather than the grid,
+    // so it stops at 256.
+    //--------------------------------------------------------------------------
+    void Suite::generation(const Dictionary& words) {
+        for (int size : gridSizes) {
+            for (int length : lengths) {
+                for (GeneratorEngine engine : { GeneratorEngine::RandomProbe, GeneratorEngine::Backtracking }) {
+                    bool backtracking = engine == GeneratorEngine::Backtracking;
+                    if (length > size || (backtracking && size > 256)) {
+                        continue;
+                    }
+                    std::string name = std::string("populateGrid/") + (backtracking ? "backtracking" : "random") +
+                        "/grid=" + std::to_string(size) + "/length=" + std::to_string(length);
+                    if (!wanted(name)) {
+                        continue;
+                    }
+                    EasyMode mode;
+                    mode.setGenerator(engine);
+                    mode.allocateGrid(size);
+                    int count = std::max(3, size / 2);
+                    add(name, 1, [] {}, [&] {
+                        Random random(BENCH_SEED);
+                        sink += mode.populateGrid(words, count, length, random).placed;
+                    });
+                }
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // search
+    // checkWordInGrid by full scan and by the grid index, against the same
+    // search done on a strip copy of the grid (find, then mark the match).
+    // Half the guesses are read off the grid, so they hit; the other half
+    // are random and almost always miss. The found mask is cleared between
+    // batches because a hit sets its cells. A full scan of a large grid is
+    // slow, so it gets fewer guesses per batch.
+    //--------------------------------------------------------------------------
+    void Suite::search(const Dictionary& words) {
+        for (int size : gridSizes) {
+            EasyMode mode;
+            mode.allocateGrid(size);
+            Random random(BENCH_SEED);
+            mode.populateGrid(words, std::max(3, size / 2), lengths.front(), random);
+            const CharGrid& grid = mode.getGrid();
+            const GridIndex& index = mode.getIndex();
+            GridStrips strips;
+            strips.build(grid);
+
+            for (int length : lengths) {
+                if (length > size) {
+                    continue;
+                }
+                std::vector<std::string> guesses;
+                int cells = size * size;
+                int guessCount = 256;
+                for (int g = 0; g < guessCount; ++g) {
+                    if (g % 2 == 1) {
+                        guesses.push_back(randomWord(random, length));
+                        continue;
+                    }
+                    int row, col, direction;
+                    do {
+                        row = random.below(size);
+                        col = random.below(size);
+                        direction = random.below(NUM_DIRECTIONS);
+                    } while (!grid.inBounds(row + (length - 1) * DIRECTION_ROW[direction], col + (length - 1) * DIRECTION_COL[direction]));
+                    std::string word;
+                    for (int k = 0; k < length; ++k) {
+                        word += grid.at(row + k * DIRECTION_ROW[direction], col + k * DIRECTION_COL[direction]);
+                    }
+                    guesses.push_back(word);
+                }
+
+                std::string suffix = "/grid=" + std::to_string(size) + "/length=" + std::to_string(length);
+                CellMask found;
+                found.reset(size);
+                auto reset = [&] { found.clear(); };
+                int scanCount = std::max(2, std::min(guessCount, (1 << 22) / cells));
+                add("checkWordInGrid/scan" + suffix, scanCount, reset, [&] {
+                    WordValidator validator;
+                    for (int g = 0; g < scanCount; ++g) {
+                        sink += validator.checkWordInGrid(guesses[g], grid, found);
+                    }
+                });
+                add("checkWordInGrid/index" + suffix, guessCount, reset, [&] {
+                    WordValidator validator;
+                    for (const std::string& guess : guesses) {
+                        sink += validator.checkWordInGrid(guess, grid, index, found);
+                    }
+                });
+                add("checkWordInGrid/strips" + suffix, guessCount, reset, [&] {
+                    WordValidator validator;
+                    for (const std::string& guess : guesses) {
+                        WordMatch match;
+                        if (strips.find(guess, grid, match)) {
+                            sink += validator.markWord(guess, found, match);
+                        }
+                    }
+                });
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // solving
+    // Finding which dictionary words a grid holds: the solver's single pass
+    // against one indexed checkWordInGrid per dictionary word, the way a
+    // caller without the solver would do it. Both report every word present;
+    // only the solver also reports repeated occurrences.
+    //--------------------------------------------------------------------------
+    void Suite::solving(const Dictionary& words) {
+        const int MAX_SOLVE_SIZE = 1024;
+        std::unique_ptr<GridSolver> solver;
+        for (int size : gridSizes) {
+            std::string suffix = "/grid=" + std::to_string(size);
+            if (size > MAX_SOLVE_SIZE || (!wanted("solveGrid/solver" + suffix) && !wanted("solveGrid/checkWordInGrid" + suffix))) {
+                continue;
+            }
+            if (!solver) {
+                solver.reset(new GridSolver(words));
+            }
+            EasyMode mode;
+            mode.allocateGrid(size);
+            Random random(BENCH_SEED);
+            mode.populateGrid(words, std::max(3, size / 2), lengths.front(), random);
+            const CharGrid& grid = mode.getGrid();
+            const GridIndex& index = mode.getIndex();
+
+            add("solveGrid/solver" + suffix, 1, [] {}, [&] {
+                sink += static_cast<long long>(solver->solve(grid, 1).size());
+            });
+            CellMask found;
+            found.reset(size);
+            add("solveGrid/checkWordInGrid" + suffix, 1, [&] { found.clear(); }, [&] {
+                WordValidator validator;
+                for (int id = 0; id < words.size(); ++id) {
+                    sink += validator.checkWordInGrid(std::string(words.word(id)), grid, index, found);
+                }
+            });
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // lookup
+    // isValidWord per dictionary size and level length, half hits and half
+    // random strings of the same length.
+    //--------------------------------------------------------------------------
+    void Suite::lookup(const std::vector<int>& dictionarySizes) {
+        for (int count : dictionarySizes) {
+            if (!wanted("isValidWord/words=" + std::to_string(count))) {
+                continue;
+            }
+            std::vector<std::string> list = syntheticWords(count, lengths);
+            Dictionary words;
+            for (const std::string& word : list) {
+                words.add(word);
+            }
+            Random random(BENCH_SEED);
+            for (int length : lengths) {
+                std::vector<std::string> guesses;
+                WordBucket bucket = words.bucket(length);
+                for (int g = 0; g < 1024; ++g) {
+                    if (g % 2 == 0 && bucket.count > 0) {
+                        guesses.emplace_back(words.word(bucket.id(random.below(bucket.count))));
+                    }
+                    else {
+                        guesses.push_back(randomWord(random, length));
+                    }
+                }
+                add("isValidWord/words=" + std::to_string(count) + "/length=" + std::to_string(length),
+                    static_cast<int>(guesses.size()), [] {}, [&] {
+                    WordValidator validator;
+                    for (const std::string& guess : guesses) {
+                        sink += validator.isValidWord(guess, words);
+                    }
+                });
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // loading
+    // loadWords from a text list and from the compiled format, per
+    // dictionary size. The files are written to the temp directory first
+    // and stay in the page cache, so this is parsing, not disk.
+    //--------------------------------------------------------------------------
+    void Suite::loading(const std::vector<int>& dictionarySizes) {
+        std::filesystem::path directory = std::filesystem::temp_directory_path();
+        for (int count : dictionarySizes) {
+            std::string suffix = "/words=" + std::to_string(count);
+            if (!wanted("loadWords/text" + suffix) && !wanted("loadWords/compiled" + suffix)) {
+                continue;
+            }
+            std::vector<std::string> list = syntheticWords(count, lengths);
+            std::string textPath = (directory / ("wordbench_" + std::to_string(count) + ".txt")).string();
+            std::string compiledPath = (directory / ("wordbench_" + std::to_string(count) + ".wgd")).string();
+            {
+                std::ofstream text(textPath);
+                for (const std::string& word : list) {
+                    text << word << '\n';
+                }
+            }
+            Dictionary::writeCompiled(compiledPath, list);
+
+            for (const std::string& path : { textPath, compiledPath }) {
+                bool compiled = path == compiledPath;
+                add(std::string("loadWords/") + (compiled ? "compiled" : "text") + suffix, 1, [] {}, [&] {
+                    WordValidator validator;
+                    Dictionary words;
+                    validator.loadWords(path, words);
+                    sink += words.size();
+                });
+            }
+            std::remove(textPath.c_str());
+            std::remove(compiledPath.c_str());
+        }
+    }
+
+    // printGrid into a stream that discards its output
+    void Suite::rendering() {
+        NullBuffer discard;
+        std::ostream nullSink(&discard);
+        Dictionary words;
+        for (const std::string& word : syntheticWords(1000, lengths)) {
+            words.add(word);
+        }
+        for (int size : gridSizes) {
+            std::string name = "printGrid/grid=" + std::to_string(size);
+            if (!wanted(name)) {
+                continue;
+            }
+            EasyMode mode;
+            mode.allocateGrid(size);
+            Random random(BENCH_SEED);
+            mode.populateGrid(words, 3, lengths.front(), random);
+            add(name, 1, [] {}, [&] { mode.printGrid(nullSink); });
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // scores
+    // The score store the game records finished games in, over files in the
+    // temp directory. appendScore appends a batch of games and waits for them
+    // to be on disk, so it counts the write and sync the writer shares among
+    // them. topScores reads a board's best five with many players on it.
+    //--------------------------------------------------------------------------
+    void Suite::scores() {
+        std::string basePath = (std::filesystem::temp_directory_path() / "wordbench_scores").string();
+        auto removeFiles = [&] {
+            std::remove((basePath + ".log").c_str());
+            std::remove((basePath + ".snapshot").c_str());
+        };
+        removeFiles();
+        {
+            ScoreStore store(basePath);
+            Random random(BENCH_SEED);
+            const int batchGames = 64;
+            add("appendScore", batchGames, [] {}, [&] {
+                for (int g = 0; g < batchGames; ++g) {
+                    store.append(ScoreEntry{ 1, 1, static_cast<std::uint64_t>(random.below(1000)), random.below(1000), 0 });
+                }
+                store.sync();
+            });
+
+            for (int players : { 1000, 100000 }) {
+                std::string name = "topScores/players=" + std::to_string(players);
+                if (!wanted(name)) {
+                    continue;
+                }
+                for (int p = 0; p < players; ++p) {
+                    store.append(ScoreEntry{ 2, 3, static_cast<std::uint64_t>(p), random.below(1000000), 0 });
+                }
+                store.sync();
+                add(name, 1, [] {}, [&] { sink += static_cast<long long>(store.top(2, 3, 5).size()); });
+            }
+        }
+        removeFiles();
+    }
+
+    void writeJson(std::ostream& out, const std::vector<Result>& results) {
+        out << "{\n  \"format\": 1,\n  \"results\": [\n";
+        char line[512];
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const Result& result = results[i];
+            std::snprintf(line, sizeof(line), "    {\"name\": \"%s\", \"ns_per_op\": %.1f, \"min_ns_per_op\": %.1f, \"ops\": %lld}%s\n",
+                result.name.c_str(), result.nsPerOp, result.minNsPerOp, result.ops, i + 1 < results.size() ? "," : "");
+            out << line;
+        }
+        out << "  ]\n}\n";
+    }
+
+    // Name to min_ns_per_op from a file written by writeJson
+    std::map<std::string, double> readBaseline(const std::string& path) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open baseline " + path);
+        }
+        std::map<std::string, double> baseline;
+        std::string line;
+        const std::string nameKey = "\"name\": \"";
+        const std::string timeKey = "\"min_ns_per_op\": ";
+        while (std::getline(file, line)) {
+            std::size_t name = line.find(nameKey);
+            std::size_t time = line.find(timeKey);
+            if (name == std::string::npos || time == std::string::npos) {
+                continue;
+            }
+            name += nameKey.size();
+            baseline[line.substr(name, line.find('"', name) - name)] = std::strtod(line.c_str() + time + timeKey.size(), nullptr);
+        }
+        return baseline;
+    }
+
+    //--------------------------------------------------------------------------
+    // compare
+    // Prints every case that moved by more than the tolerance and returns
+    // the number that got slower. The fastest sample is compared, since
+    // interference from the rest of the machine only ever adds time. Cases
+    // missing from the baseline are listed but do not fail the run.
+    //--------------------------------------------------------------------------
+    int compare(const std::vector<Result>& results, const std::map<std::string, double>& baseline, double tolerance) {
+        int slower = 0, faster = 0, missing = 0;
+        for (const Result& result : results) {
+            auto previous = baseline.find(result.name);
+            if (previous == baseline.end()) {
+                std::cerr << "new      " << result.name << "\n";
+                ++missing;
+                continue;
+            }
+            double ratio = result.minNsPerOp / std::max(previous->second, 1e-3);
+            if (ratio > 1.0 + tolerance) {
+                std::cerr << "SLOWER   " << result.name << ": " << previous->second << " -> " << result.minNsPerOp << " ns/op (x" << ratio << ")\n";
+                ++slower;
+            }
+            else if (ratio < 1.0 / (1.0 + tolerance)) {
+                std::cerr << "faster   " << result.name << ": " << previous->second << " -> " << result.minNsPerOp << " ns/op (x" << ratio << ")\n";
+                ++faster;
+            }
+        }
+        std::cerr << results.size() << " cases: " << slower << " slower, " << faster << " faster, " << missing
+            << " not in baseline (tolerance " << tolerance * 100 << "%)" << std::endl;
+        return slower;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Settings settings;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            settings.quick = true;
+        }
+        else if (arg == "--filter" && i + 1 < argc) {
+            settings.filter = argv[++i];
+        }
+        else if (arg == "--samples" && i + 1 < argc) {
+            settings.samples = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--rounds" && i + 1 < argc) {
+            settings.rounds = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--out" && i + 1 < argc) {
+            settings.outPath = argv[++i];
+        }
+        else if (arg == "--compare" && i + 1 < argc) {
+            settings.baselinePath = argv[++i];
+        }
+        else if (arg == "--tolerance" && i + 1 < argc) {
+            settings.tolerance = std::atof(argv[++i]);
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--quick] [--filter text] [--samples n] [--rounds n] [--out file]"
+                " [--compare baseline.json] [--tolerance 0.25]" << std::endl;
+            return 2;
+        }
+    }
+
+    try {
+        std::map<std::string, double> baseline;
+        if (!settings.baselinePath.empty()) {
+            baseline = readBaseline(settings.baselinePath); // Fail before the long run, not after
+        }
+
+        std::vector<Result> results;
+        for (int round = 0; round < settings.rounds; ++round) {
+            Suite suite(settings);
+            suite.run();
+            if (round == 0) {
+                results = suite.results();
+                continue;
+            }
+            for (std::size_t i = 0; i < results.size(); ++i) {
+                const Result& again = suite.results()[i];
+                results[i].nsPerOp = std::min(results[i].nsPerOp, again.nsPerOp);
+                results[i].minNsPerOp = std::min(results[i].minNsPerOp, again.minNsPerOp);
+                results[i].ops += again.ops;
+            }
+        }
+
+        if (settings.outPath.empty()) {
+            writeJson(std::cout, results);
+        }
+        else {
+            std::ofstream out(settings.outPath);
+            writeJson(out, results);
+        }
+        if (!settings.baselinePath.empty()) {
+            return compare(results, baseline, settings.tolerance) == 0 ? 0 : 1;
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
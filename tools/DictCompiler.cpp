@@ -0,0 +1,57 @@
+#include "../header.h"
+
+//------------------------------------------------------------------------------
+// DictCompiler
+// Compiles any number of word lists into one binary dictionary that the game
+// and solver can map without parsing.
+//
+// Usage: dictc -o <output.wgd> <words.txt> [more.txt ...]
+//------------------------------------------------------------------------------
+int main(int argc, char* argv[]) {
+    using namespace WordGame;
+
+    std::string output;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        }
+        else {
+            inputs.push_back(arg);
+        }
+    }
+    if (output.empty() || inputs.empty()) {
+        std::cerr << "Usage: " << argv[0] << " -o <output.wgd> <words.txt> [more.txt ...]" << std::endl;
+        return 2;
+    }
+
+    std::vector<std::string> words;
+    try {
+        for (const std::string& input : inputs) {
+            Dictionary list;
+            list.load(input);
+            words.reserve(words.size() + list.size());
+            for (int id = 0; id < list.size(); ++id) {
+                words.emplace_back(list.word(id));
+            }
+            std::cout << input << ": " << list.size() << " words" << std::endl;
+        }
+        Dictionary::writeCompiled(output, std::move(words));
+
+        Dictionary compiled;
+        compiled.load(output);
+        std::cout << output << ": " << compiled.size() << " distinct words" << std::endl;
+        for (int length = 1; length <= MAX_WORD_LENGTH; ++length) {
+            WordBucket bucket = compiled.bucket(length);
+            if (bucket.count > 0) {
+                std::cout << "  length " << length << ": " << bucket.count << std::endl;
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
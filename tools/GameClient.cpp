@@ -0,0 +1,262 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// GameClient
+// Talks to `wordgame --serve`. Without --load it is an interactive client:
+// lines typed on stdin go to the server and its replies are printed. With
+// --load it opens many connections at once, plays a scripted game on each
+// and reports how many sessions completed and how long they took.
+//
+// Usage: wordclient [--host addr] [--port n] [--unix path]
+//                   [--load <connections>] [--script "a,1,1,zz,..."]
+//------------------------------------------------------------------------------
+
+namespace {
+
+    struct ClientOptions {
+        std::string host = "127.0.0.1";
+        int port = 7070;
+        std::string unixPath;
+        int load = 0; // Scripted connections, 0 for interactive
+        std::string script = "a,1,1,zz,zz,zz,zz,zz,n,e"; // Easy level 1, five misses, no retry, exit
+    };
+
+    // Connected socket, non-blocking if asked, or -1
+    int connectTo(const ClientOptions& options, bool nonBlocking) {
+        int type = SOCK_STREAM | SOCK_CLOEXEC | (nonBlocking ? SOCK_NONBLOCK : 0);
+        int fd;
+        int result;
+        if (!options.unixPath.empty()) {
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            std::strncpy(address.sun_path, options.unixPath.c_str(), sizeof(address.sun_path) - 1);
+            fd = socket(AF_UNIX, type, 0);
+            if (fd < 0) {
+                return -1;
+            }
+            result = connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        }
+        else {
+            sockaddr_in address = {};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<unsigned short>(options.port));
+            if (inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1) {
+                return -1;
+            }
+            fd = socket(AF_INET, type, 0);
+            if (fd < 0) {
+                return -1;
+            }
+            result = connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        }
+        if (result != 0 && !(nonBlocking && (errno == EINPROGRESS || errno == EAGAIN))) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    //--------------------------------------------------------------------------
+    // runInteractive
+    // Relays stdin to the server and the server to stdout until either side
+    // closes.
+    //--------------------------------------------------------------------------
+    int runInteractive(const ClientOptions& options) {
+        int fd = connectTo(options, false);
+        if (fd < 0) {
+            std::cerr << "Error: cannot connect: " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+        pollfd fds[2] = { { fd, POLLIN, 0 }, { STDIN_FILENO, POLLIN, 0 } };
+        char buffer[4096];
+        bool stdinOpen = true;
+        while (true) {
+            if (poll(fds, stdinOpen ? 2 : 1, -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+                ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+                if (received <= 0) {
+                    break;
+                }
+                std::cout.write(buffer, received);
+                std::cout.flush();
+            }
+            if (stdinOpen && (fds[1].revents & (POLLIN | POLLHUP))) {
+                ssize_t typed = read(STDIN_FILENO, buffer, sizeof(buffer));
+                if (typed <= 0) {
+                    stdinOpen = false;
+                    shutdown(fd, SHUT_WR);
+                }
+                else if (send(fd, buffer, static_cast<std::size_t>(typed), MSG_NOSIGNAL) != typed) {
+                    break;
+                }
+            }
+        }
+        close(fd);
+        return 0;
+    }
+
+    struct Player {
+        int fd = -1;
+        std::size_t sent = 0; // Script bytes written so far
+        std::size_t received = 0; // Reply bytes read so far
+        bool done = false;
+    };
+
+    //--------------------------------------------------------------------------
+    // runLoad
+    // Connects every player, writes the whole script to each as soon as it
+    // can, and reads until the server closes the connection at the end of
+    // the script. A session counts as completed when the server said goodbye.
+    //--------------------------------------------------------------------------
+    int runLoad(const ClientOptions& options) {
+        rlimit limit;
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+        }
+
+        std::string script;
+        for (char ch : options.script) {
+            script += ch == ',' ? '\n' : ch;
+        }
+        script += '\n';
+        const std::string goodbye = "Goodbye!\n";
+
+        auto started = std::chrono::steady_clock::now();
+        int epollFd = epoll_create1(EPOLL_CLOEXEC);
+        std::vector<Player> players(options.load);
+        int open = 0, failed = 0, completed = 0;
+        for (Player& player : players) {
+            player.fd = connectTo(options, true);
+            if (player.fd < 0) {
+                ++failed;
+                player.done = true;
+                continue;
+            }
+            epoll_event event = {};
+            event.events = EPOLLIN | EPOLLOUT;
+            event.data.ptr = &player;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, player.fd, &event);
+            ++open;
+        }
+        auto connected = std::chrono::steady_clock::now();
+
+        std::vector<epoll_event> events(1024);
+        std::vector<char> buffer(65536);
+        std::vector<std::string> tails(options.load); // Last bytes of each reply stream
+        while (open > 0) {
+            int count = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 10000);
+            if (count <= 0) {
+                if (count < 0 && errno == EINTR) {
+                    continue;
+                }
+                break; // Nothing happened for ten seconds
+            }
+            for (int i = 0; i < count; ++i) {
+                Player& player = *static_cast<Player*>(events[i].data.ptr);
+                std::size_t index = &player - players.data();
+                if ((events[i].events & EPOLLOUT) && player.sent < script.size()) {
+                    ssize_t written = send(player.fd, script.data() + player.sent, script.size() - player.sent, MSG_NOSIGNAL);
+                    if (written > 0) {
+                        player.sent += static_cast<std::size_t>(written);
+                    }
+                    if (player.sent == script.size()) {
+                        epoll_event event = {};
+                        event.events = EPOLLIN;
+                        event.data.ptr = &player;
+                        epoll_ctl(epollFd, EPOLL_CTL_MOD, player.fd, &event);
+                    }
+                }
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    ssize_t received = recv(player.fd, buffer.data(), buffer.size(), 0);
+                    if (received > 0) {
+                        player.received += static_cast<std::size_t>(received);
+                        tails[index].append(buffer.data(), static_cast<std::size_t>(received));
+                        if (tails[index].size() > goodbye.size()) {
+                            tails[index].erase(0, tails[index].size() - goodbye.size());
+                        }
+                        continue;
+                    }
+                    if (received < 0 && (errno == EAGAIN || errno == EINTR)) {
+                        continue;
+                    }
+                    if (tails[index] == goodbye) {
+                        ++completed;
+                    }
+                    else {
+                        ++failed;
+                    }
+                    epoll_ctl(epollFd, EPOLL_CTL_DEL, player.fd, nullptr);
+                    close(player.fd);
+                    player.done = true;
+                    --open;
+                }
+            }
+        }
+        for (Player& player : players) {
+            if (!player.done) {
+                close(player.fd);
+                ++failed;
+            }
+        }
+        close(epollFd);
+
+        auto finished = std::chrono::steady_clock::now();
+        std::size_t bytes = 0;
+        for (const Player& player : players) {
+            bytes += player.received;
+        }
+        std::cout << options.load << " sessions: " << completed << " completed, " << failed << " failed, "
+            << bytes << " bytes received\n";
+        std::cout << "connect " << std::chrono::duration<double, std::milli>(connected - started).count() << " ms, total "
+            << std::chrono::duration<double, std::milli>(finished - started).count() << " ms" << std::endl;
+        return failed == 0 ? 0 : 1;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    ClientOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--host" && i + 1 < argc) {
+            options.host = argv[++i];
+        }
+        else if (arg == "--port" && i + 1 < argc) {
+            options.port = std::atoi(argv[++i]);
+        }
+        else if (arg == "--unix" && i + 1 < argc) {
+            options.unixPath = argv[++i];
+        }
+        else if (arg == "--load" && i + 1 < argc) {
+            options.load = std::atoi(argv[++i]);
+        }
+        else if (arg == "--script" && i + 1 < argc) {
+            options.script = argv[++i];
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--host addr] [--port n] [--unix path] [--load <connections>] [--script \"a,1,1,...\"]" << std::endl;
+            return 2;
+        }
+    }
+    return options.load > 0 ? runLoad(options) : runInteractive(options);
+}
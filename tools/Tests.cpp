@@ -0,0 +1,146 @@
+#include "../header.h"
+#include <cstring>
+#include <functional>
+
+//------------------------------------------------------------------------------
+// Tests
+// Regression checks for inputs the game must refuse without touching memory it
+// does not own. Each test prints its failed checks; the exit status is the
+// number of tests that failed.
+//
+// Usage: wordtest
+//------------------------------------------------------------------------------
+
+namespace {
+
+    using namespace WordGame;
+
+    int failedChecks = 0; // Failed checks in the running test
+
+    void check(bool condition, const char* what) {
+        if (!condition) {
+            std::cout << "    failed: " << what << '\n';
+            ++failedChecks;
+        }
+    }
+
+    bool sameBits(const CellMask& a, const CellMask& b) {
+        return a.words() == b.words() && std::memcmp(a.data(), b.data(), a.words() * sizeof(std::uint64_t)) == 0;
+    }
+
+    //--------------------------------------------------------------------------
+    // emptyGuess
+    // An empty guess is not a word: neither search finds it and the found
+    // mask is left as it was, including the bits of an earlier find.
+    //--------------------------------------------------------------------------
+    void emptyGuess() {
+        CharGrid grid(5);
+        grid.fill('x');
+        const char* word = "cat";
+        for (int k = 0; k < 3; ++k) {
+            grid.set(1, 1 + k, word[k]);
+        }
+        GridIndex index;
+        index.build(grid);
+        WordValidator validator;
+        validator.setSearchThreads(1);
+        CellMask found;
+        found.reset(grid.size());
+        check(validator.checkWordInGrid("cat", grid, index, found), "a placed word is found");
+        CellMask before = found;
+
+        check(!validator.checkWordInGrid("", grid, found), "the scan rejects an empty guess");
+        check(!validator.checkWordInGrid("", grid, index, found), "the index rejects an empty guess");
+        check(!validator.markWord("", found, WordMatch{ 0, 0, 0, -1 }), "markWord rejects an empty word");
+        check(sameBits(found, before), "the found mask is unchanged");
+
+        found.setRow(2, 0, 0);
+        check(sameBits(found, before), "setRow with no cells changes nothing");
+    }
+
+    //--------------------------------------------------------------------------
+    // Field offsets in a session snapshot's 88-byte header (Session.cpp)
+    //--------------------------------------------------------------------------
+    const std::size_t SNAPSHOT_HEADER_BYTES = 88;
+    const std::size_t SNAPSHOT_CHECKSUM_AT = 16;
+    const std::size_t SNAPSHOT_GRID_SIZE_AT = 72;
+    const std::size_t SNAPSHOT_WORD_COUNT_AT = 82;
+    const std::size_t SNAPSHOT_FOUND_COUNT_AT = 86;
+
+    // A copy of a saved snapshot with new word counts, ids 0.. for the found
+    // words and a matching checksum, so only the counts can give it away
+    std::string craftSnapshot(const std::string& saved, std::int16_t wordCount, std::int16_t foundCount) {
+        std::uint16_t gridSize;
+        std::int16_t savedFound;
+        std::memcpy(&gridSize, saved.data() + SNAPSHOT_GRID_SIZE_AT, sizeof(gridSize));
+        std::memcpy(&savedFound, saved.data() + SNAPSHOT_FOUND_COUNT_AT, sizeof(savedFound));
+        std::size_t maskBytes = (static_cast<std::size_t>(gridSize) * gridSize + 63) / 64 * sizeof(std::uint64_t);
+        std::size_t idsAt = SNAPSHOT_HEADER_BYTES + maskBytes;
+
+        std::string crafted = saved.substr(0, idsAt);
+        for (std::int32_t id = 0; id < foundCount; ++id) {
+            crafted.append(reinterpret_cast<const char*>(&id), sizeof(id));
+        }
+        crafted += saved.substr(idsAt + savedFound * sizeof(std::int32_t));
+        std::memcpy(&crafted[SNAPSHOT_WORD_COUNT_AT], &wordCount, sizeof(wordCount));
+        std::memcpy(&crafted[SNAPSHOT_FOUND_COUNT_AT], &foundCount, sizeof(foundCount));
+        std::uint64_t checksum = Dictionary::hash(crafted.data() + SNAPSHOT_CHECKSUM_AT + sizeof(checksum),
+            crafted.size() - SNAPSHOT_CHECKSUM_AT - sizeof(checksum));
+        std::memcpy(&crafted[SNAPSHOT_CHECKSUM_AT], &checksum, sizeof(checksum));
+        return crafted;
+    }
+
+    bool restores(GameSession& session, const std::string& snapshot) {
+        try {
+            session.restore(snapshot.data(), snapshot.size());
+            return true;
+        }
+        catch (const std::runtime_error&) {
+            return false;
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // craftedSnapshot
+    // A snapshot with a valid checksum but word counts no game can reach is
+    // rejected, so a later correct guess cannot write past the found ids.
+    // Needs easy_words.txt in the working directory.
+    //--------------------------------------------------------------------------
+    void craftedSnapshot() {
+        GameSession session(1, false);
+        session.start();
+        session.handleLine("a");
+        session.handleLine("1");
+        session.handleLine("1"); // Easy, level 1: three words to find
+        std::string saved;
+        session.save(saved);
+
+        GameSession restored(2, false);
+        check(restores(restored, craftSnapshot(saved, 3, 0)), "an unchanged snapshot restores");
+        check(!restores(restored, craftSnapshot(saved, 16, 16)), "16 of 16 words found is rejected");
+        check(!restores(restored, craftSnapshot(saved, 3, 15)), "more words found than level 1 holds is rejected");
+        check(!restores(restored, craftSnapshot(saved, 7, 0)), "more words than level 1 has is rejected");
+        check(restored.handleLine("zzz").find("Chances remaining") != std::string::npos, "the session still plays");
+    }
+
+    struct Test {
+        const char* name;
+        std::function<void()> run;
+    };
+
+} // namespace
+
+int main() {
+    const Test tests[] = {
+        { "emptyGuess", emptyGuess },
+        { "craftedSnapshot", craftedSnapshot },
+    };
+    int failedTests = 0;
+    for (const Test& test : tests) {
+        failedChecks = 0;
+        test.run();
+        std::cout << (failedChecks == 0 ? "pass " : "FAIL ") << test.name << '\n';
+        failedTests += failedChecks == 0 ? 0 : 1;
+    }
+    return failedTests;
+}